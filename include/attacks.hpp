@@ -0,0 +1,146 @@
+// Licensed after GNU GPL v3
+
+#ifndef __ATTACKS_HPP__
+#define __ATTACKS_HPP__
+
+#if defined(USE_PEXT)
+#include <immintrin.h>
+#endif
+
+#include "board_constants.hpp"
+
+// All tables here are indexed by the square of 64 squares board
+// and contain bitboards of attacked squares
+
+// Squares attacked by a piece which makes one step in each of `dirs`
+// directions of 120 squares board (knights, kings and pawns)
+template <size_t N>
+consteval auto leaperAttacks(const std::array<char, N> &dirs) {
+  std::array<size_t, regularNC> attacks{};
+
+  for (int sq64 = 0; sq64 < regularNC; ++sq64) {
+    int sq = board64[sq64];
+    for (char dir : dirs)
+      if (bFiles[sq + dir] != OFFBOARD)
+        attacks[sq64] |= setMask[board120[sq + dir]];
+  }
+
+  return attacks;
+}
+
+constexpr auto knightAttacks = leaperAttacks(knightMoves);
+
+constexpr auto kingAttacks = leaperAttacks(kingMoves);
+
+// Usage: pawnAttacks[color][sq64]
+constexpr std::array<std::array<size_t, regularNC>, 2> pawnAttacks {
+  leaperAttacks(std::array<char, 2>{9, 11}),   // WHITE
+  leaperAttacks(std::array<char, 2>{-9, -11}), // BLACK
+};
+
+// Usage: betweenBB[sq64_1][sq64_2], lineBB[sq64_1][sq64_2]
+// betweenBB - squares strictly between two squares on the same line,
+// lineBB    - whole line (including edges) which goes through both squares,
+// both are empty if squares aren't on the same rank, file or diagonal
+using squaresTable = std::array<std::array<size_t, regularNC>, regularNC>;
+
+consteval std::pair<squaresTable, squaresTable> lineTables() {
+  squaresTable between{}, line{};
+
+  for (int sq64 = 0; sq64 < regularNC; ++sq64) {
+    int sq = board64[sq64];
+
+    for (char dir : kingMoves) {
+      size_t ray = 0ull, full = setMask[sq64];
+
+      for (int t = sq + dir; bFiles[t] != OFFBOARD; t += dir)
+        full |= setMask[board120[t]];
+      for (int t = sq - dir; bFiles[t] != OFFBOARD; t -= dir)
+        full |= setMask[board120[t]];
+
+      for (int t = sq + dir; bFiles[t] != OFFBOARD; t += dir) {
+        between[sq64][board120[t]] = ray;
+        line[sq64][board120[t]] = full;
+        ray |= setMask[board120[t]];
+      }
+    }
+  }
+
+  return {between, line};
+}
+
+constexpr auto betweenBB = lineTables().first;
+constexpr auto lineBB    = lineTables().second;
+
+// Sliding pieces attacks are taken from "fancy magic" tables:
+// occupied squares on the rays of the piece (`mask`) are mapped
+// to the unique index of precomputed attacks set, either by
+// multiplication on the magic number or by BMI2 `pext` instruction
+// (build with USE_PEXT option)
+struct Magic {
+  size_t   mask;
+  size_t   magic;
+  size_t  *attacks;
+  unsigned shift;
+
+  unsigned index(const size_t occupied) const {
+#if defined(USE_PEXT)
+    return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+    return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+  }
+};
+
+// Filled before main() in `attacks.cpp`
+extern std::array<Magic, regularNC> bishopMagics;
+extern std::array<Magic, regularNC> rookMagics;
+
+inline size_t bishopAttacks(const unsigned char sq64, const size_t occupied) {
+  const Magic &m = bishopMagics[sq64];
+  return m.attacks[m.index(occupied)];
+}
+
+inline size_t rookAttacks(const unsigned char sq64, const size_t occupied) {
+  const Magic &m = rookMagics[sq64];
+  return m.attacks[m.index(occupied)];
+}
+
+inline size_t queenAttacks(const unsigned char sq64, const size_t occupied) {
+  return bishopAttacks(sq64, occupied) | rookAttacks(sq64, occupied);
+}
+
+// Is the square attacked by any piece of `side`,
+// `pieceBB` are bitboards of each type of piece.
+// A pawn of `side` attacks the square if it stands on a square which
+// a pawn of the other color would attack from this square
+inline bool isSquareAttacked(const std::array<size_t, 13> &pieceBB,
+                             const size_t occupied, const unsigned char sq64,
+                             const Color side) {
+  bool white = side == WHITE;
+
+  return (pawnAttacks[side ^ 1][sq64] & pieceBB[white ? wP : bP]) ||
+         (knightAttacks[sq64] & pieceBB[white ? wN : bN]) ||
+         (kingAttacks[sq64] & pieceBB[white ? wK : bK]) ||
+         (bishopAttacks(sq64, occupied) &
+          (pieceBB[white ? wB : bB] | pieceBB[white ? wQ : bQ])) ||
+         (rookAttacks(sq64, occupied) &
+          (pieceBB[white ? wR : bR] | pieceBB[white ? wQ : bQ]));
+}
+
+// All pieces of both colors which attack the square. Pieces removed
+// from `occupied` don't block sliders, so x-ray attackers behind them
+// are found as well
+inline size_t squareAttackers(const std::array<size_t, 13> &pieceBB,
+                              const size_t occupied, const unsigned char sq64) {
+  return (pawnAttacks[BLACK][sq64] & pieceBB[wP]) |
+         (pawnAttacks[WHITE][sq64] & pieceBB[bP]) |
+         (knightAttacks[sq64] & (pieceBB[wN] | pieceBB[bN])) |
+         (kingAttacks[sq64] & (pieceBB[wK] | pieceBB[bK])) |
+         (bishopAttacks(sq64, occupied) &
+          (pieceBB[wB] | pieceBB[bB] | pieceBB[wQ] | pieceBB[bQ])) |
+         (rookAttacks(sq64, occupied) &
+          (pieceBB[wR] | pieceBB[bR] | pieceBB[wQ] | pieceBB[bQ]));
+}
+
+#endif // __ATTACKS_HPP__
@@ -3,11 +3,12 @@
 #ifndef __BOARD_HPP__
 #define __BOARD_HPP__
 
+#include <algorithm>
 #include <iostream>
 #include <unordered_map>
-#include <vector>
 
 #include "move.hpp"
+#include "nnue.hpp"
 
 namespace board {
 class Board {
@@ -22,6 +23,13 @@ class Board {
   // Will be very helpful in the move generation phase
   std::array<size_t, 3> pawns;
 
+  // Bitboard for each type of piece, indexed in the same way as `pieceNum`
+  // (bitboard of EMPTY is always zero)
+  std::array<size_t, 13> pieceBB;
+
+  // Occupancy bitboards: white pieces, black pieces and all pieces
+  std::array<size_t, 3> colorBB;
+
   // It is useful to keep the positions of kings
   // on the board for the same reason.
   // `unsigned char` is used because there are only 120 possible
@@ -45,12 +53,19 @@ class Board {
   size_t ply;
 
   // Amount of all half moves has been made
-  // Indexing for the history vector (maybe unnessesary)
+  // Index of the first free entry of the history stack
   size_t hisPly;
 
   // Unique key of position
   size_t posKey;
 
+  // Key of pawns only, same Zobrist keys as in `posKey`
+  size_t pawnKey;
+
+  // Accumulators of the network evaluation, they are updated
+  // with the pieces only if attached
+  nnue::AccumulatorStack *accumulators = nullptr;
+
   // Contains number of each piece type
   std::array<unsigned char, 13> pieceNum;
 
@@ -67,8 +82,13 @@ class Board {
   // Material score for black and white
   std::array<unsigned, 2> material;
 
-  // History of the game
-  std::vector<move::Undo> history;
+  // Sums of piece-square tables for the middlegame and the endgame,
+  // white minus black
+  std::array<int, 2> psq;
+
+  // History of the game: preallocated undo stack,
+  // history[i] keeps the state before i-th half move
+  std::array<move::Undo, maxGameMoves> history;
 
   // Piece list is a matrix that contain a type of piece in the current position
   // For example: we want to set white knight to the board on E1 square
@@ -77,6 +97,11 @@ class Board {
   // We also don't need to look through all empty squares
   std::array<std::array<unsigned char, 10>, 13> pieceList;
 
+  // Reverse index for the piece list: position of the piece standing
+  // on the square in its list, so pieceList[board[sq]][pieceIndex[sq]] == sq
+  // Valid only for occupied squares
+  std::array<unsigned char, largeNC> pieceIndex;
+
 #if defined(DEBUG_ONLY)
   // Strings for Board::dump
   static constexpr std::string_view pieceChar = ".PNBRQKpnbrqk";
@@ -106,6 +131,38 @@ public:
   unsigned char getCastlePerm() const noexcept {
     return castlePerm;
   };
+  unsigned char getFiftyMove() const noexcept { return fiftyMove; }
+  size_t getPosKey() const noexcept { return posKey; }
+  size_t getPawnKey() const noexcept { return pawnKey; }
+  nnue::AccumulatorStack *getAccumulators() const noexcept {
+    return accumulators;
+  }
+  size_t getPly() const noexcept { return ply; }
+  // Move which led to the current position, empty move if there is none
+  move::Move getLastMove() const {
+    return hisPly ? history[hisPly - 1].getMove() : move::Move();
+  }
+  unsigned getMaterial(const Color col) const { return material[col]; }
+  int getPsq(const GamePhase phase) const { return psq[phase]; }
+
+  // From maxPhase with all pieces on the board down to 0 without them.
+  // majPiece counts kings and queens with rooks, so kings are taken
+  // out and queens are added once more
+  int getPhase() const {
+    int phase = minPiece[WHITE] + minPiece[BLACK] +
+                2 * (majPiece[WHITE] + majPiece[BLACK] - 2 + pieceNum[wQ] +
+                     pieceNum[bQ]);
+    return std::min(phase, maxPhase);
+  }
+  unsigned char getKing(const Color col) const {
+    return col == WHITE ? kings.first : kings.second;
+  }
+  size_t getPieceBB(const unsigned char piece) const {
+    return pieceBB[piece];
+  }
+  size_t getColorBB(const Color col) const {
+    return colorBB[col];
+  }
 
   // Other methods (defined in `board.cpp`)
 public:
@@ -121,7 +178,7 @@ public:
   // Dumping board and some statistics to screen
   void dump(std::ostream &os) const;
 
-  // Updating piece lists
+  // Rebuilding piece lists, bitboards and counters from the board
   void update();
 
   // Check all lists are correct
@@ -130,10 +187,25 @@ public:
   // Checking is square attacked by side
   bool isAttacked(const unsigned char sq, const Color side) const;
 
+  // Bitboard of all pieces of both colors attacking the square,
+  // sliders see through the pieces missing in `occupied`
+  size_t attackersTo(const unsigned char sq, const size_t occupied) const;
+  size_t attackersTo(const unsigned char sq) const {
+    return attackersTo(sq, colorBB[BOTH]);
+  }
+
+  // Was current position met before since the last capture or pawn move
+  bool isRepetition() const;
+
+  // Is king of the side to move attacked
+  bool inCheck() const { return isAttacked(getKing(side), Color(side ^ 1)); }
+
   // Methods that will change position key
 private:
-  void hashPiece(const unsigned char piece, const unsigned char sq)
-                    { posKey ^= pieceKeys[piece][sq]; }
+  void hashPiece(const unsigned char piece, const unsigned char sq) {
+    posKey  ^= pieceKeys[piece][sq];
+    pawnKey ^= pieceKeys[piece][sq] & -size_t(pieceP[piece]);
+  }
   void hashCastle() { posKey ^= castleKeys[castlePerm]; }
   void hashSide()   { posKey ^= sideKey; }
   void hashEnPas()  { posKey ^= pieceKeys[EMPTY][enPas]; }
@@ -143,20 +215,54 @@ private:
   void clearPiece(const unsigned char sq);
   void addPiece(const unsigned char sq, const unsigned char piece);
   void movePiece(const unsigned char from, const unsigned char to);
+
+  // Making and taking back move of the side `Us` without checking
+  // king safety, makeMove and takeBackMove pick the instantiation
+  template <Color Us> void doMove(const move::Move& move);
+  template <Color Us> void undoMove();
   
 public:
   void takeBackMove();
+
+  // Both return false without making the move if the history is full,
+  // games longer than maxGameMoves half moves can't be played on.
+  // Returns false and takes move back if it leaves king in check
   bool makeMove(const move::Move& move);
+
+  // For moves from MoveList::generateLegalMoves, king safety isn't checked
+  bool makeLegalMove(const move::Move& move);
   
-  bool history_empty() const noexcept { return history.empty(); }
+  // Current position becomes the root of the search
+  void resetPly() noexcept { ply = 0; }
+
+  // Network accumulators will follow moves made from the current
+  // position, nullptr detaches them. Copies of the board share them,
+  // so every search thread attaches its own. Setting up a new position
+  // with parseFEN detaches them as well
+  void attach(nnue::AccumulatorStack *acc) {
+    accumulators = acc;
+    if (accumulators)
+      accumulators->reset(*this);
+  }
+
+  bool history_empty() const noexcept { return hisPly == 0; }
+  bool history_full() const noexcept { return hisPly >= maxGameMoves; }
   void print_history(std::ostream& o) {
     Board b(startPos);
-    for (int i = 0; i < history.size(); ++i) {
+    for (size_t i = 0; i < hisPly; ++i) {
       b.makeMove(history[i].getMove());
       b.dump(o);
     }
   }
 };
+
+// parseFEN doesn't check its input, it may read past the string or
+// overflow piece lists. FEN is valid if it has 8 ranks of 8 squares with
+// one king of each color, no pawns on the first and the last ranks and
+// no more pieces than piece lists hold, then the side to move, castling
+// rights and the en passant square behind a pawn which has just moved,
+// separated by single spaces. Fields after them are ignored
+bool validFEN(std::string_view fen);
 } // namespace board
 
 #endif // __BOARD_HPP__
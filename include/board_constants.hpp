@@ -33,16 +33,49 @@ enum Cell : unsigned char {
 // 1011 - black queen can castle only to king's side, white can do both
 enum CastlePerm : unsigned char { WKC = 1, WQC = 2, BKC = 4, BQC = 8 };
 
-extern std::array<std::array<size_t, 120>, 13> pieceKeys;
-extern std::array<size_t, 16> castleKeys;
-extern size_t sideKey;
-
 // NC - Number of Cells
 constexpr int largeNC = 120;
 constexpr int regularNC = 64;
 
 constexpr int maxMoves = 256;
 
+// Maximum number of half moves in the game, size of the undo stack
+constexpr int maxGameMoves = 2048;
+
+// Zobrist keys for hashing the position
+// pieceKeys[piece][sq] - piece on the square of 120 squares board,
+// pieceKeys[EMPTY][sq] is used for en passant square
+// castleKeys[castlePerm] - castle permissions
+// sideKey - white to move
+// Keys come from the fixed seed, so they are the same in every build and run
+struct ZobristKeys {
+  std::array<std::array<size_t, largeNC>, 13> piece;
+  std::array<size_t, 16> castle;
+  size_t side;
+};
+
+consteval ZobristKeys zobristKeys() {
+  util::PRNG rng(1070372);
+  ZobristKeys keys{};
+
+  for (auto &pieceKeys : keys.piece)
+    for (auto &key : pieceKeys)
+      key = rng.rand();
+
+  for (auto &key : keys.castle)
+    key = rng.rand();
+
+  keys.side = rng.rand();
+
+  return keys;
+}
+
+constexpr ZobristKeys zobrist = zobristKeys();
+
+constexpr auto   pieceKeys  = zobrist.piece;
+constexpr auto   castleKeys = zobrist.castle;
+constexpr size_t sideKey    = zobrist.side;
+
 constexpr std::array<unsigned char, regularNC> bitTable{
     63, 30, 3,  32, 25, 41, 22, 33, 15, 50, 42, 13, 11, 53, 19, 34,
     61, 29, 2,  51, 21, 43, 45, 10, 18, 47, 1,  54, 9,  57, 0,  35,
@@ -72,6 +105,142 @@ constexpr std::array pieceMin{false, false, true, true,  false, false, false,
 constexpr std::array pieceVal{0, 100, 325, 325, 550,  1000, INT_MAX,
                                  100, 325, 325, 550,  1000, INT_MAX};
 
+// Piece-square tables are kept separately for the middlegame
+// and the endgame, evaluation blends them by the game phase
+enum GamePhase : unsigned char { MG, EG };
+
+// Phase of the position with all pieces on the board, it goes down to 0
+// as pieces are exchanged: minor piece counts 1, rook 2, queen 4
+constexpr int maxPhase = 24;
+
+// Bonus of a piece for its square, white pieces of each type (P, N, B, R,
+// Q, K) as seen from the white side: the first row is the 8th rank
+constexpr std::array<std::array<std::array<int, regularNC>, 6>, 2> pstWhite{{
+  {{ // MG
+    {  0,  0,  0,  0,  0,  0,  0,  0,
+      50, 50, 50, 50, 50, 50, 50, 50,
+      10, 10, 20, 30, 30, 20, 10, 10,
+       5,  5, 10, 25, 25, 10,  5,  5,
+       0,  0,  0, 20, 20,  0,  0,  0,
+       5, -5,-10,  0,  0,-10, -5,  5,
+       5, 10, 10,-20,-20, 10, 10,  5,
+       0,  0,  0,  0,  0,  0,  0,  0},
+    {-50,-40,-30,-30,-30,-30,-40,-50,
+     -40,-20,  0,  0,  0,  0,-20,-40,
+     -30,  0, 10, 15, 15, 10,  0,-30,
+     -30,  5, 15, 20, 20, 15,  5,-30,
+     -30,  0, 15, 20, 20, 15,  0,-30,
+     -30,  5, 10, 15, 15, 10,  5,-30,
+     -40,-20,  0,  5,  5,  0,-20,-40,
+     -50,-40,-30,-30,-30,-30,-40,-50},
+    {-20,-10,-10,-10,-10,-10,-10,-20,
+     -10,  0,  0,  0,  0,  0,  0,-10,
+     -10,  0,  5, 10, 10,  5,  0,-10,
+     -10,  5,  5, 10, 10,  5,  5,-10,
+     -10,  0, 10, 10, 10, 10,  0,-10,
+     -10, 10, 10, 10, 10, 10, 10,-10,
+     -10,  5,  0,  0,  0,  0,  5,-10,
+     -20,-10,-10,-10,-10,-10,-10,-20},
+    {  0,  0,  0,  0,  0,  0,  0,  0,
+       5, 10, 10, 10, 10, 10, 10,  5,
+      -5,  0,  0,  0,  0,  0,  0, -5,
+      -5,  0,  0,  0,  0,  0,  0, -5,
+      -5,  0,  0,  0,  0,  0,  0, -5,
+      -5,  0,  0,  0,  0,  0,  0, -5,
+      -5,  0,  0,  0,  0,  0,  0, -5,
+       0,  0,  0,  5,  5,  0,  0,  0},
+    {-20,-10,-10, -5, -5,-10,-10,-20,
+     -10,  0,  0,  0,  0,  0,  0,-10,
+     -10,  0,  5,  5,  5,  5,  0,-10,
+      -5,  0,  5,  5,  5,  5,  0, -5,
+       0,  0,  5,  5,  5,  5,  0, -5,
+     -10,  5,  5,  5,  5,  5,  0,-10,
+     -10,  0,  5,  0,  0,  0,  0,-10,
+     -20,-10,-10, -5, -5,-10,-10,-20},
+    {-30,-40,-40,-50,-50,-40,-40,-30,
+     -30,-40,-40,-50,-50,-40,-40,-30,
+     -30,-40,-40,-50,-50,-40,-40,-30,
+     -30,-40,-40,-50,-50,-40,-40,-30,
+     -20,-30,-30,-40,-40,-30,-30,-20,
+     -10,-20,-20,-20,-20,-20,-20,-10,
+      20, 20,  0,  0,  0,  0, 20, 20,
+      20, 30, 10,  0,  0, 10, 30, 20},
+  }},
+  {{ // EG
+    {  0,  0,  0,  0,  0,  0,  0,  0,
+      80, 80, 80, 80, 80, 80, 80, 80,
+      50, 50, 50, 50, 50, 50, 50, 50,
+      30, 30, 30, 30, 30, 30, 30, 30,
+      15, 15, 15, 15, 15, 15, 15, 15,
+       5,  5,  5,  5,  5,  5,  5,  5,
+       0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0},
+    {-50,-40,-30,-30,-30,-30,-40,-50,
+     -40,-20,  0,  0,  0,  0,-20,-40,
+     -30,  0, 10, 15, 15, 10,  0,-30,
+     -30,  5, 15, 20, 20, 15,  5,-30,
+     -30,  0, 15, 20, 20, 15,  0,-30,
+     -30,  5, 10, 15, 15, 10,  5,-30,
+     -40,-20,  0,  5,  5,  0,-20,-40,
+     -50,-40,-30,-30,-30,-30,-40,-50},
+    {-20,-10,-10,-10,-10,-10,-10,-20,
+     -10,  0,  0,  0,  0,  0,  0,-10,
+     -10,  0,  5, 10, 10,  5,  0,-10,
+     -10,  5,  5, 10, 10,  5,  5,-10,
+     -10,  0, 10, 10, 10, 10,  0,-10,
+     -10, 10, 10, 10, 10, 10, 10,-10,
+     -10,  5,  0,  0,  0,  0,  5,-10,
+     -20,-10,-10,-10,-10,-10,-10,-20},
+    {  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0},
+    {-20,-10,-10, -5, -5,-10,-10,-20,
+     -10,  0,  0,  0,  0,  0,  0,-10,
+     -10,  0,  5,  5,  5,  5,  0,-10,
+      -5,  0,  5,  5,  5,  5,  0, -5,
+      -5,  0,  5,  5,  5,  5,  0, -5,
+     -10,  0,  5,  5,  5,  5,  0,-10,
+     -10,  0,  0,  0,  0,  0,  0,-10,
+     -20,-10,-10, -5, -5,-10,-10,-20},
+    {-50,-40,-30,-20,-20,-30,-40,-50,
+     -30,-20,-10,  0,  0,-10,-20,-30,
+     -30,-10, 20, 30, 30, 20,-10,-30,
+     -30,-10, 30, 40, 40, 30,-10,-30,
+     -30,-10, 30, 40, 40, 30,-10,-30,
+     -30,-10, 20, 30, 30, 20,-10,-30,
+     -30,-30,  0,  0,  0,  0,-30,-30,
+     -50,-30,-30,-30,-30,-30,-30,-50},
+  }},
+}};
+
+// Usage: pieceSquare[phase][piece][sq120]
+// Scores are from the view of white: black pieces take the bonus
+// of the vertically mirrored square with the minus sign
+using PieceSquare =
+    std::array<std::array<std::array<int, largeNC>, 13>, 2>;
+
+consteval PieceSquare pieceSquareTables() {
+  PieceSquare tables{};
+
+  for (int phase = MG; phase <= EG; ++phase)
+    for (int type = 0; type < 6; ++type)
+      for (int sq64 = 0; sq64 < regularNC; ++sq64) {
+        // 21 is A1 of 120 squares board, every rank takes 10 squares
+        int sq120 = 21 + sq64 % 8 + sq64 / 8 * 10;
+        tables[phase][wP + type][sq120] =  pstWhite[phase][type][sq64 ^ 56];
+        tables[phase][bP + type][sq120] = -pstWhite[phase][type][sq64];
+      }
+
+  return tables;
+}
+
+constexpr auto pieceSquare = pieceSquareTables();
+
 // What color is piece
 constexpr std::array<Color, 13> pieceCol{
     BOTH,  WHITE, WHITE, WHITE, WHITE, WHITE, WHITE,
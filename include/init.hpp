@@ -1,11 +0,0 @@
-// Licensed after GNU GPL v3
-
-#ifndef __INIT_HPP__
-#define __INIT_HPP__
-
-#include "board.hpp"
-
-void initHash();
-void allInit();
-
-#endif // __INIT_HPP__
@@ -3,14 +3,17 @@
 #ifndef __MOVE_HPP__
 #define __MOVE_HPP__
 
-#include <vector>
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <span>
 #include <string>
 
 #include "board_constants.hpp"
 
 // Forward declaration
 // We can't #include "board.hpp" because of cyclic dependency
-namespace board { class Board; }
+namespace board { class Board; class Position; }
 
 namespace move {
 /*
@@ -42,9 +45,6 @@ namespace move {
 class Move {
   unsigned info;
   unsigned score;
-#if defined(DEBUG_ONLY)
-  std::string dump_str;
-#endif
 public:
   Move() : info(0), score(0) {}
   Move(int i) : info(i), score(0) {}
@@ -53,7 +53,7 @@ public:
       : info(from | (to << 7) | (captured << 14) | (promoted << 20) | flag),
         score(0) {}
 
-  std::string getDumpMove();
+  std::string getDumpMove() const;
 
   unsigned getInfo()  const { return info; }
   unsigned getScore() const { return score; }
@@ -61,6 +61,9 @@ public:
   void SetInfo(int i)  { info  = i; }
   void SetScore(int s) { score = s; }
 
+  // Captures, en passant and promotions, everything else is quiet
+  bool isTactical() const { return info & 0xf7c000; }
+
   unsigned char getFrom()         const { return info & 0x7f; }
   unsigned char getTo()           const { return (info >> 7) & 0x7f; }
   unsigned char getCaptured()     const { return (info >> 14) & 0xf; }
@@ -72,15 +75,20 @@ public:
   unsigned char getPromotedBits() const { return info & 0xf00000; }
 };
 
-class MoveList {
-private:
-  std::vector<Move> moves;
+// Kinds of moves for staged generation
+enum GenType : unsigned char {
+  CAPTURES, // Captures, en passant and all promotions
+  QUIETS,   // All other moves including castling
+  EVASIONS, // Moves which may get king out of check, for positions in check
+  ALL
+};
 
+// Fixed-capacity list of moves, it lives on the stack of its owner,
+// so move generation never allocates memory
+class MoveList {
 private:
-  void AddQuietMove(const board::Board &b, Move &&m);
-  void AddCapturedMove(const board::Board &b, Move &&m);
-  void AddEnPasMove(const board::Board &b, Move &&m);
-  void AddPawnMove(const board::Board &b, Move &&m, bool captured);
+  std::array<Move, maxMoves> moves;
+  size_t count = 0;
 
   // Constructor
 public:
@@ -89,38 +97,81 @@ public:
   
   // Some public methods
 public:
-  size_t size() const { return moves.size(); }
+  size_t size() const { return count; }
   Move operator[](int i) const { return moves[i]; }
-  void push_back(Move &m) { moves.push_back(m); }
+  Move &operator[](int i) { return moves[i]; }
+  void push_back(const Move &m) {
+    assert(count < maxMoves);
+    moves[count++] = m;
+  }
   void dump(std::ostream &os) const;
-  void clear() { moves.clear(); }
+  void clear() { count = 0; }
+
+  // Partial selection sort: swaps the move with the highest score among
+  // [i, size) to i and returns it. Moves are picked one by one, so after
+  // a cutoff the rest of the list is never sorted
+  Move pickBest(size_t i);
 
-  // Move generation
+  // Move generation, both methods replace the content of the list
 public:
+  // Pseudo-legal moves, makeMove rejects the ones which leave king in check
   void generateAllMoves(const board::Board &b);
 
+  // Legal moves only: checkers and pinned pieces are computed once,
+  // so these moves can be made with makeLegalMove
+  void generateLegalMoves(const board::Board &b);
+
+  // Same for the compact position used in copy-make mode
+  void generateAllMoves(const board::Position &p);
+  void generateLegalMoves(const board::Position &p);
+
+  // Pseudo-legal moves of one GenType, used by MovePicker stages
+  void generateCaptures(const board::Board &b);
+  void generateQuiets(const board::Board &b);
+  void generateEvasions(const board::Board &b);
+
   // Iterator support
 public:
   auto begin()   const { return moves.begin(); }
-  auto end()     const { return moves.end(); }
-  auto rbegin()  const { return moves.rbegin(); }
-  auto rend()    const { return moves.rend(); }
-  auto crbegin() const { return moves.crbegin(); }
-  auto crend()   const { return moves.crend(); }
+  auto end()     const { return moves.begin() + count; }
+  auto rbegin()  const { return std::make_reverse_iterator(end()); }
+  auto rend()    const { return std::make_reverse_iterator(begin()); }
+  auto crbegin() const { return rbegin(); }
+  auto crend()   const { return rend(); }
 };
 
-// Information to undo a move
+// Same generators which write moves to the buffer provided by caller,
+// they return number of generated moves.
+// Instantiated for <ALL, false>, <ALL, true> and pseudo-legal staged types
+template <GenType Type, bool Legal>
+size_t generate(const board::Board &b, std::span<Move, maxMoves> list);
+
+// Instantiated for <ALL, false> and <ALL, true>
+template <GenType Type, bool Legal>
+size_t generate(const board::Position &p, std::span<Move, maxMoves> list);
+
+size_t generateAllMoves(const board::Board &b, std::span<Move, maxMoves> list);
+size_t generateLegalMoves(const board::Board &b, std::span<Move, maxMoves> list);
+
+// Number of legal moves, same as generateLegalMoves, but moves are
+// only counted. Used at the last ply of perft
+size_t countLegalMoves(const board::Board &b);
+
+// Information to undo a move, one entry of Board's undo stack
 class Undo {
   Move move;
   unsigned char castlePerm;
   Cell enPas;
   unsigned char fiftyMove;
+  unsigned char captured;
   size_t posKey;
 
   // Constructor
 public:
+  Undo() = default;
   Undo(Move m, int cp, Cell ep, unsigned char fm, size_t pk)
-      : move(m), castlePerm(cp), enPas(ep), fiftyMove(fm), posKey(pk) {}
+      : move(m), castlePerm(cp), enPas(ep), fiftyMove(fm),
+        captured(m.getCaptured()), posKey(pk) {}
 
   // Getters
 public:
@@ -128,7 +179,8 @@ public:
   unsigned char getCastlePerm() const { return castlePerm; }
   Cell getEnPas()               const { return enPas; }
   unsigned char getFiftyMove()  const { return fiftyMove; }
-
+  unsigned char getCaptured()   const { return captured; }
+  size_t getPosKey()            const { return posKey; }
 };
 
 char *getDumpSquare(const int sq);
@@ -0,0 +1,38 @@
+// Licensed after GNU GPL v3
+
+#ifndef __MOVEPICKER_HPP__
+#define __MOVEPICKER_HPP__
+
+#include "move.hpp"
+
+namespace move {
+// Gives moves one by one and runs every generation stage only
+// when moves of the previous one are used up:
+// 1. Captures, en passant and promotions, in MVV-LVA order
+// 2. Quiet moves
+// If side to move is in check, the only stage is evasions.
+// Moves are pseudo-legal, so they must be made with Board::makeMove
+class MovePicker {
+  enum Stage : unsigned char {
+    GEN_CAPTURES, PICK_CAPTURES,
+    GEN_QUIETS,   PICK_QUIETS,
+    GEN_EVASIONS, PICK_EVASIONS,
+    FINISHED
+  };
+
+  const board::Board &b;
+  MoveList list;
+  size_t cur = 0;
+  Stage stage;
+
+  // Constructor
+public:
+  MovePicker(const board::Board &b);
+
+  // Returns false when there are no moves left
+public:
+  bool next(Move &m);
+};
+} // namespace move
+
+#endif // __MOVEPICKER_HPP__
@@ -0,0 +1,110 @@
+// Licensed after GNU GPL v3
+
+#ifndef __NNUE_HPP__
+#define __NNUE_HPP__
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board_constants.hpp"
+
+// Forward declaration, board.hpp includes this file
+namespace board { class Board; }
+
+namespace nnue {
+/*
+ * Optional evaluation by a small "efficiently updatable" network.
+ *
+ * Input features are HalfKP-like: for each perspective (white, black)
+ * a feature is (king square, piece except kings, square of the piece),
+ * squares are flipped vertically for black, so both perspectives share
+ * the first layer. Its output for each perspective is the accumulator,
+ * which is updated incrementally as pieces move.
+ *
+ * 2 x halfDims accumulator -> clipped ReLU -> l1 -> clipped ReLU -> l2
+ * -> clipped ReLU -> 1, the half of the side to move goes first
+ */
+constexpr size_t pieceKinds = 10; // P, N, B, R, Q of own and other side
+constexpr size_t inputs     = regularNC * pieceKinds * regularNC;
+constexpr size_t halfDims   = 128;
+constexpr size_t l1 = 32, l2 = 32;
+
+// Hidden layers' sums are shifted right by weightShift before the next
+// layer, the output is divided by outputScale to get centipawns
+constexpr int weightShift = 6;
+constexpr int outputScale = 16;
+
+// Network file: the header, then little-endian arrays one after another
+//   int16 ftBias[halfDims],  int16 ftWeights[inputs][halfDims],
+//   int32 l1Bias[l1],        int8  l1Weights[l1][2 * halfDims],
+//   int32 l2Bias[l2],        int8  l2Weights[l2][l1],
+//   int32 outBias,           int8  outWeights[l2]
+struct Header {
+  std::array<char, 4> magic{'C', 'E', 'N', 'N'};
+  uint32_t version = 1;
+  uint32_t inputs = nnue::inputs, halfDims = nnue::halfDims;
+  uint32_t l1 = nnue::l1, l2 = nnue::l2;
+};
+
+constexpr size_t fileSize = sizeof(Header) + 2 * halfDims +
+                            2 * inputs * halfDims + 4 * l1 +
+                            l1 * 2 * halfDims + 4 * l2 + l2 * l1 + 4 + l2;
+
+// Maps the network file to memory, weights are used right from the
+// mapping. Returns false if the file can't be read or has other layout,
+// the previous network (if any) is unloaded anyway
+bool load(const std::string &path);
+void unload();
+bool loaded();
+
+struct alignas(32) Accumulator {
+  // values[perspective]
+  std::array<std::array<int16_t, halfDims>, 2> values;
+
+  // King of the perspective has moved, all features of it have changed,
+  // so it's rebuilt from the board before the next move is pushed
+  // or when the position is evaluated
+  std::array<bool, 2> dirty;
+};
+
+// Accumulators of the positions from the one of `reset` to the current
+// one. Board pushes a copy before each move and updates it from
+// addPiece/clearPiece/movePiece, taking back the move pops it.
+// There is room for as many moves as Board keeps in its history
+class AccumulatorStack {
+  static constexpr size_t capacity = maxGameMoves + 1;
+
+  std::vector<Accumulator> stack;
+  size_t top = 0;
+
+  void update(const board::Board &b, const unsigned char piece,
+              const unsigned char sq, const bool add);
+
+public:
+  AccumulatorStack() : stack(capacity) {}
+
+  // The only accumulator is computed from scratch for the position
+  void reset(const board::Board &b);
+
+  // Dirty perspectives are rebuilt before the copy, so that a king move
+  // is refreshed once and not in every position below it
+  void push(const board::Board &b);
+  void pop();
+
+  void addPiece(const board::Board &b, unsigned char piece, unsigned char sq);
+  void clearPiece(const board::Board &b, unsigned char piece, unsigned char sq);
+  void movePiece(const board::Board &b, unsigned char piece,
+                 unsigned char from, unsigned char to);
+
+  // Rebuilds dirty perspectives and returns the accumulator of the position
+  const Accumulator &current(const board::Board &b);
+};
+
+// Score of the position from the view of the side to move, it's never
+// a mate score. The network must be loaded
+int evaluate(const board::Board &b, AccumulatorStack &accumulators);
+} // namespace nnue
+
+#endif // __NNUE_HPP__
@@ -0,0 +1,106 @@
+// Licensed after GNU GPL v3
+
+#ifndef __PAWNS_HPP__
+#define __PAWNS_HPP__
+
+#include <vector>
+
+#include "board.hpp"
+
+namespace search {
+// Masks of 64 squares board for pawn structure evaluation,
+// the ones which depend on direction are indexed by color of the pawn
+struct PawnMasks {
+  // Usage: adjacent[sq64] - both neighbouring files
+  std::array<size_t, regularNC> adjacent;
+
+  // Usage: front[color][sq64] - squares in front on the same file
+  std::array<std::array<size_t, regularNC>, 2> front;
+
+  // Usage: passed[color][sq64] - squares in front on the same and
+  // neighbouring files, no enemy pawn there means a passed pawn
+  std::array<std::array<size_t, regularNC>, 2> passed;
+
+  // Usage: support[color][sq64] - neighbouring files on the same rank
+  // and behind, pawns which can defend the square now or later
+  std::array<std::array<size_t, regularNC>, 2> support;
+};
+
+consteval PawnMasks pawnMasks() {
+  PawnMasks masks{};
+
+  for (int sq = 0; sq < regularNC; ++sq)
+    for (int other = 0; other < regularNC; ++other) {
+      int file = sq % 8, rank = sq / 8;
+      int dFile = other % 8 - file, dRank = other / 8 - rank;
+      size_t bb = 1ull << other;
+
+      if (dFile == 1 || dFile == -1) {
+        masks.adjacent[sq] |= bb;
+        masks.support[WHITE][sq] |= dRank <= 0 ? bb : 0;
+        masks.support[BLACK][sq] |= dRank >= 0 ? bb : 0;
+      }
+
+      if (dFile >= -1 && dFile <= 1) {
+        masks.passed[WHITE][sq] |= dRank > 0 ? bb : 0;
+        masks.passed[BLACK][sq] |= dRank < 0 ? bb : 0;
+      }
+
+      if (dFile == 0) {
+        masks.front[WHITE][sq] |= dRank > 0 ? bb : 0;
+        masks.front[BLACK][sq] |= dRank < 0 ? bb : 0;
+      }
+    }
+
+  return masks;
+}
+
+constexpr auto pawnMask = pawnMasks();
+
+// Scores of pawn structure terms: [MG, EG]
+constexpr std::array doubledPawn  {-10, -20};
+constexpr std::array isolatedPawn {-10, -15};
+constexpr std::array backwardPawn { -8, -10};
+
+// Usage: passedPawn[phase][rank counted from the own side]
+constexpr std::array<std::array<int, 8>, 2> passedPawn{{
+  {0, 5, 10, 15, 25, 40, 60, 0},
+  {0, 10, 20, 35, 60, 90, 130, 0},
+}};
+
+// Number of pawns of each kind, white minus black
+struct PawnTerms {
+  int doubled = 0, isolated = 0, backward = 0;
+  std::array<int, 8> passed{}; // by rank counted from the own side
+};
+
+PawnTerms countPawnTerms(const board::Board &b);
+
+// Pawn structure score of both phases, from the view of white
+struct PawnEntry {
+  size_t key;
+  std::array<int, 2> score;
+};
+
+PawnEntry evaluatePawns(const board::Board &b);
+
+// Cache of pawn structure scores indexed by Board::getPawnKey.
+// Every search thread owns its table, so there are no locks.
+// Empty entries have key 0 and score 0, which is right for the only
+// structure with key 0 - no pawns at all
+class PawnTable {
+  std::vector<PawnEntry> entries;
+  size_t probes = 0, hits = 0;
+
+public:
+  // Number of entries is rounded down to a power of two
+  explicit PawnTable(size_t size = 1 << 14);
+
+  const std::array<int, 2> &probe(const board::Board &b);
+
+  size_t getProbes() const { return probes; }
+  size_t getHits() const { return hits; }
+};
+} // namespace search
+
+#endif // __PAWNS_HPP__
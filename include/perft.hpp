@@ -0,0 +1,90 @@
+// Licensed after GNU GPL v3
+
+#ifndef __PERFT_HPP__
+#define __PERFT_HPP__
+
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "board.hpp"
+
+namespace perft {
+// Number of leaf nodes of the legal moves tree with the given depth
+size_t perft(board::Board &b, const unsigned char depth);
+
+// Perft of every root move
+struct DivideEntry {
+  move::Move move;
+  size_t nodes;
+};
+
+std::vector<DivideEntry> divide(board::Board &b, const unsigned char depth);
+
+// Deepest split of the parallel perft. Every node at the split depth
+// is stored as a task before counting starts, 3 plies are ~100K tasks
+// in middlegame positions, 4 plies would be millions
+constexpr unsigned char maxSplitDepth = 3;
+
+// Parallel perft: the tree is split into tasks `splitDepth` plies below
+// the root (clamped to maxSplitDepth) and tasks are dealt round-robin to
+// the queues of `threads` workers (all hardware threads if 0) before they
+// start. Queues are filled once, stealing by idle workers only rebalances
+// the tail of the work. Every worker counts on its own copy of `b`
+std::vector<DivideEntry> parallelDivide(const board::Board &b,
+                                        const unsigned char depth,
+                                        unsigned threads = 0,
+                                        unsigned char splitDepth = 2);
+
+size_t parallelPerft(const board::Board &b, const unsigned char depth,
+                     unsigned threads = 0, unsigned char splitDepth = 2);
+
+// Fixed-size table of subtree counts keyed on (posKey, depth),
+// deeper subtrees replace shallower ones
+class PerftTable {
+  struct Entry {
+    size_t key;
+    size_t nodes;
+    unsigned char depth; // 0 - empty entry
+  };
+
+  std::vector<Entry> entries;
+
+  // Cross-check every hit against the uncached count
+  bool verify;
+  size_t collisions;
+
+public:
+  // Number of entries is the largest power of 2 fitting into `mb` megabytes
+  explicit PerftTable(const size_t mb, const bool verify = false);
+
+  bool probe(const size_t key, const unsigned char depth, size_t &nodes) const;
+  void store(const size_t key, const unsigned char depth, const size_t nodes);
+  void clear();
+
+  size_t size() const noexcept { return entries.size(); }
+  bool verifying() const noexcept { return verify; }
+  size_t getCollisions() const noexcept { return collisions; }
+  void addCollision() noexcept { ++collisions; }
+};
+
+// Perft which counts every cached subtree once
+size_t hashPerft(board::Board &b, const unsigned char depth, PerftTable &table);
+
+// One line of the perft suite:
+// <FEN> ;D1 <nodes> ;D2 <nodes> ...
+// nodes[i] is the expected number of leaf nodes at depth i + 1
+struct TestCase {
+  std::string fen;
+  std::vector<size_t> nodes;
+};
+
+TestCase parseTestCase(const std::string_view &line);
+
+// Reads all non-empty lines of the suite,
+// nothing if any of them has an invalid FEN
+std::optional<std::vector<TestCase>> loadSuite(std::istream &is);
+} // namespace perft
+
+#endif // __PERFT_HPP__
@@ -0,0 +1,91 @@
+// Licensed after GNU GPL v3
+
+#ifndef __POSITION_HPP__
+#define __POSITION_HPP__
+
+#include <bit>
+#include <type_traits>
+
+#include "move.hpp"
+
+namespace board {
+class Board;
+
+// Compact position for the copy-make mode: a move is made on the copy
+// of the parent position and is never taken back.
+// It keeps only what move generation and hashing need (no piece lists,
+// counters or history), so it is trivially copyable and can be
+// handed to another thread as it is.
+class Position {
+  // 120 squares board, contains type of piece on each square
+  std::array<unsigned char, largeNC> board;
+
+  // Same as in Board: bitboards of each piece type and occupancy
+  std::array<size_t, 13> pieceBB;
+  std::array<size_t, 3> colorBB;
+
+  // Unique key of position
+  size_t posKey;
+
+  Color side;
+  Cell enPas;
+  unsigned char fiftyMove;
+  unsigned char castlePerm;
+
+  // Constructors
+public:
+  Position() = default;
+  explicit Position(const Board &b);
+  explicit Position(const std::string_view &fen);
+
+  // Getters, they are named as in Board, so move generation works with both
+public:
+  Color getSide() const noexcept { return side; }
+  Cell getEnPas() const noexcept { return enPas; }
+  unsigned char getCastlePerm() const noexcept { return castlePerm; }
+  unsigned char getFiftyMove() const noexcept { return fiftyMove; }
+  size_t getPosKey() const noexcept { return posKey; }
+
+  unsigned char getPiece(const unsigned char sq) const {
+    return board[sq];
+  }
+  unsigned char getKing(const Color col) const {
+    return convert64To120(std::countr_zero(pieceBB[col == WHITE ? wK : bK]));
+  }
+  size_t getPieceBB(const unsigned char piece) const {
+    return pieceBB[piece];
+  }
+  size_t getColorBB(const Color col) const {
+    return colorBB[col];
+  }
+
+  // Other methods (defined in `position.cpp`)
+public:
+  // Generating unique position key
+  size_t generate() const;
+
+  // Check bitboards and key are correct
+  void check() const;
+
+  // Checking is square attacked by side
+  bool isAttacked(const unsigned char sq, const Color side) const;
+
+  // Is king of the side to move attacked
+  bool inCheck() const { return isAttacked(getKing(side), Color(side ^ 1)); }
+
+  // Copy-make: `child` becomes this position after the move.
+  // Returns false if the move leaves king in check
+  bool makeMove(const move::Move &move, Position &child) const;
+
+private:
+  void clearPiece(const unsigned char sq);
+  void addPiece(const unsigned char sq, const unsigned char piece);
+  void movePiece(const unsigned char from, const unsigned char to);
+
+  template <Color Us> void doMove(const move::Move &move);
+};
+
+static_assert(std::is_trivially_copyable_v<Position>);
+} // namespace board
+
+#endif // __POSITION_HPP__
@@ -0,0 +1,148 @@
+// Licensed after GNU GPL v3
+
+#ifndef __SEARCH_HPP__
+#define __SEARCH_HPP__
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "board.hpp"
+#include "pawns.hpp"
+#include "tt.hpp"
+
+namespace search {
+// Scores are in centipawns from the view of the side to move
+constexpr int infinite = 32000;
+constexpr int mate = 31000;
+
+// Deepest ply the search can reach
+constexpr unsigned char maxPly = 64;
+
+// Quiescence search skips captures which can't raise alpha even with
+// this bonus on top of the captured piece
+constexpr int deltaMargin = 200;
+
+// Score of the position from the view of the side to move: material,
+// piece-square tables and pawn structure blended by the game phase.
+// Board keeps the first two up to date in make/unmake, pawn structure
+// is taken from the table if it's given
+int evaluate(const board::Board &b);
+// As above, but if the board has network accumulators attached,
+// the network evaluates the position instead
+int evaluate(const board::Board &b, PawnTable &pawns);
+
+// Static exchange evaluation: material result of the move followed by
+// all captures on its target square, each side capturing with the least
+// valuable piece and free to stop. Pins are ignored
+int see(const board::Board &b, const move::Move &m);
+
+// Is score a mate in some moves
+inline bool isMate(const int score) {
+  return score >= mate - maxPly || score <= -mate + maxPly;
+}
+
+struct Limits {
+  unsigned char depth = maxPly - 1;
+  size_t nodes = 0; // 0 - no limit
+};
+
+struct Result {
+  move::Move bestMove;
+  int score = 0;
+  unsigned char depth = 0; // depth of the last completed iteration
+  size_t nodes = 0;
+  std::vector<move::Move> pv;
+};
+
+// Negamax alpha-beta search with principal variation search and
+// iterative deepening. The board is searched in place, every move is
+// taken back, so it is the same position after the search
+class Searcher {
+  board::Board &b;
+  Limits limits;
+
+  // Optional, search works without it
+  TranspositionTable *tt;
+
+  // Set by the main thread of parallel search when helpers must stop
+  const std::atomic<bool> *stop;
+
+  // Helper of parallel search searches every iteration this much deeper
+  unsigned char depthOffset;
+
+  size_t nodes = 0;
+  bool stopped = false;
+
+  PawnTable pawnTable;
+
+  // Attached to the board for the search if the network is loaded
+  // and the board has no accumulators of its own
+  std::unique_ptr<nnue::AccumulatorStack> accumulators;
+
+  // Triangular PV table: pvTable[ply] is the best line found from ply,
+  // its moves are pvTable[ply][ply .. pvLength[ply] - 1]
+  std::array<std::array<move::Move, maxPly>, maxPly> pvTable;
+  std::array<unsigned char, maxPly> pvLength;
+
+  // Best move of the previous iteration, it is searched first
+  // if the table has nothing for the root
+  move::Move rootBest;
+
+  // Quiet moves which caused a beta cutoff at the same ply
+  std::array<std::array<move::Move, 2>, maxPly> killers;
+
+  // Butterfly history [side][from64][to64] of quiet moves,
+  // raised by depth * depth on every beta cutoff
+  std::array<std::array<std::array<unsigned, regularNC>, regularNC>, 2> history;
+
+  // Quiet move which refuted the previous move, by its [piece][to]
+  std::array<std::array<move::Move, largeNC>, 13> counterMoves;
+
+  void countNode();
+
+  // Order: the move from the table, captures and promotions which don't
+  // lose material by MVV-LVA, killers, the counter move, then quiet moves
+  // by history mixed with losing captures by MVV-LVA
+  void scoreMoves(move::MoveList &l, const move::Move &ttMove) const;
+  void updateQuietStats(const move::Move &m, int depth);
+
+  // Only captures and promotions are searched at the leaves of the main
+  // search, until the position is quiet
+  int quiescence(int alpha, int beta);
+  int negamax(int alpha, int beta, int depth);
+
+  // Constructor
+public:
+  Searcher(board::Board &b, const Limits &limits,
+           TranspositionTable *tt = nullptr,
+           const std::atomic<bool> *stop = nullptr,
+           unsigned char depthOffset = 0)
+      : b(b), limits(limits), tt(tt), stop(stop), depthOffset(depthOffset) {}
+
+public:
+  Result search();
+
+  // Quiescence search of the position with the full window,
+  // the position is quiet if it equals the static evaluation
+  int qsearch();
+};
+
+inline Result search(board::Board &b, const Limits &limits,
+                     TranspositionTable *tt = nullptr) {
+  if (tt)
+    tt->newSearch();
+  return Searcher(b, limits, tt).search();
+}
+
+// Lazy SMP: `threads` searchers (all hardware threads if 0) run iterative
+// deepening on their own copies of the board and share only the table
+// and the stop flag. Every second helper searches one ply deeper, so
+// threads spread over different depths and fill the table for each other.
+// The result is the one of the main thread, which obeys `limits`;
+// helpers stop when it is done. Nodes of all threads are summed
+Result parallelSearch(const board::Board &b, const Limits &limits,
+                      TranspositionTable &tt, unsigned threads = 0);
+} // namespace search
+
+#endif // __SEARCH_HPP__
@@ -0,0 +1,79 @@
+// Licensed after GNU GPL v3
+
+#ifndef __TT_HPP__
+#define __TT_HPP__
+
+#include <atomic>
+#include <memory>
+
+#include "move.hpp"
+
+namespace search {
+// What the stored score means
+enum Bound : unsigned char {
+  BOUND_NONE,
+  UPPER, // score <= real score, all moves failed low
+  LOWER, // score >= real score, beta cut-off
+  EXACT
+};
+
+struct TTEntry {
+  move::Move move;
+  int score;
+  unsigned char depth;
+  Bound bound;
+};
+
+// Transposition table shared by search threads without locks.
+// Every entry is two words: packed data and the key XOR data.
+// A torn write (key of one store, data of another) breaks the checksum,
+// so such entry is seen as a miss instead of the wrong position
+class TranspositionTable {
+  // data: move (25 bits) | score (16) | depth (8) | bound (2) | age (6)
+  struct Slot {
+    std::atomic<size_t> check;
+    std::atomic<size_t> data;
+  };
+
+  // Slots of the bucket share one cache line
+  static constexpr size_t bucketSize = 4;
+  struct alignas(64) Bucket {
+    std::array<Slot, bucketSize> slots;
+  };
+
+  std::unique_ptr<Bucket[]> buckets;
+  size_t count = 0;
+
+  // Age of the current search, older entries are replaced first
+  unsigned char age = 0;
+
+  static size_t pack(const move::Move &move, const int score,
+                     const unsigned char depth, const Bound bound,
+                     const unsigned char age);
+
+  Bucket &bucket(const size_t key) const {
+    return buckets[key & (count - 1)];
+  }
+
+  // Constructor
+public:
+  explicit TranspositionTable(const size_t mb = 16) { resize(mb); }
+
+public:
+  // Number of buckets is the largest power of 2 fitting into `mb` megabytes,
+  // all entries are lost
+  void resize(const size_t mb);
+  void clear();
+
+  // Called before every search, entries of previous searches become old
+  void newSearch() { age = (age + 1) & 63; }
+
+  bool probe(const size_t key, TTEntry &entry) const;
+  void store(const size_t key, const move::Move &move, const int score,
+             const unsigned char depth, const Bound bound);
+
+  size_t size() const noexcept { return count * bucketSize; }
+};
+} // namespace search
+
+#endif // __TT_HPP__
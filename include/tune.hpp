@@ -0,0 +1,69 @@
+// Licensed after GNU GPL v3
+
+#ifndef __TUNE_HPP__
+#define __TUNE_HPP__
+
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "board.hpp"
+
+namespace tune {
+/*
+ * Texel tuning of the classical evaluation. The evaluation is linear in
+ * its parameters, so a position is reduced once to the coefficients of
+ * the parameters (white count minus black count) and the game phase,
+ * then it's evaluated for any parameters without the board.
+ *
+ * Parameters, all from the view of white:
+ *   material[5]                  P, N, B, R, Q, for both phases
+ *   pst[2][6][64]                [phase][type][square] as in pstWhite
+ *   doubled, isolated, backward  [phase] each
+ *   passed[2][8]                 [phase][rank] as in passedPawn
+ */
+constexpr size_t materialOffset = 0;
+constexpr size_t pstOffset      = materialOffset + 5;
+constexpr size_t pawnsOffset    = pstOffset + 2 * 6 * regularNC;
+constexpr size_t passedOffset   = pawnsOffset + 3 * 2;
+constexpr size_t numParams      = passedOffset + 2 * 8;
+
+using Params = std::vector<double>;
+
+// Parameters the engine evaluates with now
+Params initialParams();
+
+// Phase the parameter is used in, material is used in both
+enum class Usage : unsigned char { BOTH, MG, EG };
+Usage usage(size_t param);
+
+struct Features {
+  int phase;
+  // (parameter, coefficient), each parameter at most once
+  std::vector<std::pair<uint16_t, int16_t>> coefs;
+};
+
+Features extract(const board::Board &b);
+
+// Share of the parameter in the score of the phase: 1 for material,
+// phase / maxPhase for middlegame ones, the rest for endgame ones
+double weight(Usage usage, int phase);
+
+// Score from the view of white, search::evaluate without rounding
+double evaluate(const Features &f, const Params &params);
+
+// Line of a dataset: FEN, then the result of the game for white as the
+// last token - "1-0", "0-1", "1/2-1/2" or a number from 0 to 1, which may
+// be in brackets or quotes ("[0.5]", "\"1-0\""). Trailing ';' is ignored.
+// FEN must pass board::validFEN, fields after the en passant square
+// are ignored. Returns false if the line doesn't look so
+bool parseLine(std::string_view line, std::string_view &fen, double &result);
+
+// Prints the parameters rounded as the tables of board_constants.hpp
+// and pawns.hpp
+void print(std::ostream &os, const Params &params);
+} // namespace tune
+
+#endif // __TUNE_HPP__
@@ -277,6 +277,23 @@ struct Sqrt : std::integral_constant < T,
     using type = sequence<T, Num>;
   };
 
+  // xorshift64star pseudo random number generator, it gives the same
+  // numbers for the same seed and can be used at compile time
+  class PRNG {
+    size_t s;
+
+  public:
+    constexpr PRNG(size_t seed) : s(seed) {}
+
+    constexpr size_t rand() {
+      s ^= s >> 12, s ^= s << 25, s ^= s >> 27;
+      return s * 2685821657736338717ull;
+    }
+
+    // Numbers with only ~1/8th of bits set
+    constexpr size_t sparse_rand() { return rand() & rand() & rand(); }
+  };
+
   // Sequence in which each number in an interval [From, To] is repeated N times
   template <std::integral T, T From, T To, size_t N>
   struct columnar_sequence {
@@ -4,23 +4,23 @@
 #define __VALID_HPP__
 #include "board_constants.hpp"
 
-bool isOnBoard(const unsigned char sq) {
+inline bool isOnBoard(const unsigned char sq) {
   return bFiles[sq] == OFFBOARD ? false : true;
 }
 
-bool isSideValid(const Color side) {
+inline bool isSideValid(const Color side) {
   return (side == WHITE || side == BLACK) ? true : false;
 }
 
-bool isFileRankValid(const unsigned char fr) {
+inline bool isFileRankValid(const unsigned char fr) {
   return (fr >= 0 && fr <= 7) ? true : false;
 }
 
-bool isPieceValidOrEmpty(const unsigned char piece) {
+inline bool isPieceValidOrEmpty(const unsigned char piece) {
   return (piece >= EMPTY && piece <= bK) ? true : false;
 }
 
-bool isPieceValid(const unsigned char piece) {
+inline bool isPieceValid(const unsigned char piece) {
   return (piece >= wP && piece <= bK) ? true : false;
 }
 
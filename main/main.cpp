@@ -4,7 +4,7 @@
 #include <cassert>
 #include <iomanip>
 
-#include "init.hpp"
+#include "board.hpp"
 
 // TODO: move all checks to tests
 
@@ -53,8 +53,6 @@ void printBoard64(auto b) {
 // 2P1P3/2PKP3/2P1P2B/8/8/8/8/r3k3 w - -Q-- 3 1 
 
 int main() {
-  allInit();
-
   board::Board b("rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQKq d6 0 2");
   b.dump(std::cout);
 
@@ -0,0 +1,118 @@
+// Licensed after GNU GPL v3
+
+#include <bit>
+#include <vector>
+
+#include "attacks.hpp"
+
+std::array<Magic, regularNC> bishopMagics;
+std::array<Magic, regularNC> rookMagics;
+
+namespace {
+// Number of all possible attack sets for every square
+constexpr size_t bishopTableSize = 0x1480;
+constexpr size_t rookTableSize   = 0x19000;
+
+std::array<size_t, bishopTableSize> bishopTable;
+std::array<size_t, rookTableSize>   rookTable;
+
+// Slow attacks generation through the 120 squares board,
+// each ray stops on the first occupied square
+size_t slidingAttacks(const unsigned char piece, const unsigned char sq64,
+                      const size_t occupied) {
+  size_t attacks = 0ull;
+  unsigned char sq = convert64To120(sq64);
+
+  for (int i = 0; i < directionNumber[piece]; ++i) {
+    char dir = pieceDirections[piece][i];
+
+    for (unsigned char t = sq + dir; bFiles[t] != OFFBOARD; t += dir) {
+      attacks |= setMask[convert120To64(t)];
+      if (occupied & setMask[convert120To64(t)])
+        break;
+    }
+  }
+
+  return attacks;
+}
+
+// Fill magic table of one type of slide piece. Algorithm:
+// 1. Take all squares attacked on the empty board except edges, this is mask
+// 2. Go through all subsets of the mask (Carry-Rippler trick) and
+//    remember real attacks for each of them
+// 3. Pick random numbers until one of them maps every subset
+//    to the index without destructive collisions
+void initMagics(const unsigned char piece, std::array<Magic, regularNC> &magics,
+                size_t *table) {
+  constexpr size_t rank1 = 0xffull, rank8 = rank1 << 56,
+                   fileA = 0x0101010101010101ull, fileH = fileA << 7;
+
+#if !defined(USE_PEXT)
+  // Seeds which find magics fast, one for each rank
+  constexpr std::array<size_t, 8> seeds{728,   10316, 55013, 32803,
+                                        12281, 15100, 16645, 255};
+
+  std::vector<size_t> occupancy(4096), reference(4096);
+  std::vector<int> epoch(4096, 0);
+  int count = 0;
+#endif
+
+  for (unsigned char sq64 = 0; sq64 < regularNC; ++sq64) {
+    unsigned char rank = sq64 / 8, file = sq64 % 8;
+
+    size_t edges = ((rank1 | rank8) & ~(rank1 << (8 * rank))) |
+                   ((fileA | fileH) & ~(fileA << file));
+
+    Magic &m = magics[sq64];
+    m.mask = slidingAttacks(piece, sq64, 0ull) & ~edges;
+    m.shift = regularNC - std::popcount(m.mask);
+    m.attacks = sq64 == 0 ? table
+                          : magics[sq64 - 1].attacks +
+                                (size_t{1} << std::popcount(magics[sq64 - 1].mask));
+
+    size_t b = 0ull;
+
+#if defined(USE_PEXT)
+    // pext maps every subset to its own index, nothing to search
+    do {
+      m.attacks[m.index(b)] = slidingAttacks(piece, sq64, b);
+      b = (b - m.mask) & m.mask;
+    } while (b);
+#else
+    size_t size = 0;
+    do {
+      occupancy[size] = b;
+      reference[size] = slidingAttacks(piece, sq64, b);
+      ++size;
+      b = (b - m.mask) & m.mask;
+    } while (b);
+
+    util::PRNG rng(seeds[rank]);
+
+    for (size_t i = 0; i < size;) {
+      // Numbers with only ~1/8th of bits set are better candidates
+      for (m.magic = 0ull; std::popcount((m.magic * m.mask) >> 56) < 6;)
+        m.magic = rng.sparse_rand();
+
+      // `epoch` avoids clearing the attacks table for every new candidate
+      for (++count, i = 0; i < size; ++i) {
+        unsigned idx = m.index(occupancy[i]);
+
+        if (epoch[idx] < count) {
+          epoch[idx] = count;
+          m.attacks[idx] = reference[i];
+        } else if (m.attacks[idx] != reference[i])
+          break;
+      }
+    }
+#endif
+  }
+}
+
+// Tables are filled once, before main() starts
+[[maybe_unused]] const bool magicsInitialized = [] {
+  initMagics(wB, bishopMagics, bishopTable.data());
+  initMagics(wR, rookMagics, rookTable.data());
+  return true;
+}();
+} // anonymous namespace
@@ -1,12 +1,15 @@
 // Licensed after GNU GPL v3
 
+#include <algorithm>
 #include <bit>
+#include <numeric>
 
 #if defined(DEBUG_ONLY)
 #include <cassert>
 #include <iomanip>
 #endif
 
+#include "attacks.hpp"
 #include "board.hpp"
 
 using namespace board;
@@ -16,15 +19,8 @@ void Board::reset() {
   using reset = util::sequence_in_shell<unsigned char, us, OFFBOARD>;
   board = reset::get();
 
-  std::fill(pawns.begin(), pawns.end(), 0ull);
-  std::fill(bigPiece.begin(), bigPiece.end(), 0);
-  std::fill(majPiece.begin(), majPiece.end(), 0);
-  std::fill(minPiece.begin(), minPiece.end(), 0);
-  std::fill(pieceNum.begin(), pieceNum.end(), 0);
-  std::fill(material.begin(), material.end(), 0u);
-  history.clear();
-
-  kings.first = kings.second = 0;
+  // Empty board, so only clears piece lists and bitboards
+  update();
 
   side       = BOTH;
   enPas      = NO_SQ;
@@ -33,6 +29,81 @@ void Board::reset() {
   ply        = 0;
   hisPly     = 0;
   posKey     = 0ull;
+
+  // Accumulators were computed for the old position
+  accumulators = nullptr;
+}
+
+bool board::validFEN(std::string_view fen) {
+  std::array<std::string_view, 4> fields;
+  for (auto &field : fields) {
+    const size_t end = fen.find(' ');
+    field = fen.substr(0, end);
+    if (field.empty())
+      return false;
+    fen = end == std::string_view::npos ? std::string_view()
+                                        : fen.substr(end + 1);
+  }
+
+  const auto [placement, side, castling, enPas] = fields;
+  constexpr std::string_view pieces = "PNBRQKpnbrqk";
+
+  // Usage: grid[rank][file], the first rank goes first
+  std::array<std::array<char, 8>, 8> grid{};
+  std::array<int, 12> count{};
+  int rank = 7, file = 0;
+
+  for (const char c : placement) {
+    if (c == '/') {
+      if (file != 8 || rank == 0)
+        return false;
+      --rank, file = 0;
+    } else if (c >= '1' && c <= '8')
+      file += c - '0';
+    else if (const size_t kind = pieces.find(c); kind != pieces.npos) {
+      if (file == 8 || ((c == 'P' || c == 'p') && (rank == 0 || rank == 7)))
+        return false;
+      grid[rank][file++] = c;
+      ++count[kind];
+    } else
+      return false;
+
+    if (file > 8)
+      return false;
+  }
+
+  if (rank != 0 || file != 8 || count[5] != 1 || count[11] != 1)
+    return false;
+
+  // Piece lists hold 10 pieces of a kind, a side has 16 pieces at most
+  for (size_t col = 0; col < 2; ++col) {
+    const auto first = count.begin() + 6 * col;
+    if (first[0] > 8 || *std::max_element(first, first + 6) > 10 ||
+        std::accumulate(first, first + 6, 0) > 16)
+      return false;
+  }
+
+  if (side != "w" && side != "b")
+    return false;
+
+  if (castling != "-" && (castling.size() > 4 ||
+                          castling.find_first_not_of("KQkq") != castling.npos))
+    return false;
+
+  if (enPas == "-")
+    return true;
+
+  // The pawn of the other side has just passed the square
+  // from its starting rank
+  const bool white = side == "w";
+  const int epRank = white ? 5 : 2, dir = white ? 1 : -1;
+  if (enPas.size() != 2 || enPas[0] < 'a' || enPas[0] > 'h' ||
+      enPas[1] - '1' != epRank)
+    return false;
+
+  file = enPas[0] - 'a';
+  return grid[epRank - dir][file] == (white ? 'p' : 'P') &&
+         !grid[epRank][file] && !grid[epRank + dir][file];
 }
 
 void Board::parseFEN(const std::string_view &fen) {
@@ -161,17 +232,36 @@ void Board::dump(std::ostream& os) const {
 }
 
 void Board::update() {
+  std::fill(pawns.begin(), pawns.end(), 0ull);
+  std::fill(pieceBB.begin(), pieceBB.end(), 0ull);
+  std::fill(colorBB.begin(), colorBB.end(), 0ull);
+  std::fill(bigPiece.begin(), bigPiece.end(), 0);
+  std::fill(majPiece.begin(), majPiece.end(), 0);
+  std::fill(minPiece.begin(), minPiece.end(), 0);
+  std::fill(pieceNum.begin(), pieceNum.end(), 0);
+  std::fill(material.begin(), material.end(), 0u);
+  std::fill(psq.begin(), psq.end(), 0);
+  pawnKey = 0ull;
+
+  kings.first = kings.second = 0;
+
   for (int i = 0; i < largeNC; ++i) {
     size_t piece = board[i];
     if (piece != OFFBOARD && piece != EMPTY) {
       int color = pieceCol[piece];
 
+      setBit(pieceBB[piece],  convert120To64(i));
+      setBit(colorBB[color],  convert120To64(i));
+      setBit(colorBB[BOTH],   convert120To64(i));
+
       if (piece == wP) {
         setBit(pawns[WHITE], convert120To64(i));
         setBit(pawns[BOTH],  convert120To64(i));
+        pawnKey ^= pieceKeys[piece][i];
       } else if (piece == bP) {
         setBit(pawns[BLACK], convert120To64(i));
         setBit(pawns[BOTH],  convert120To64(i));
+        pawnKey ^= pieceKeys[piece][i];
       } else
         bigPiece[color]++;
 
@@ -186,6 +276,9 @@ void Board::update() {
         kings.second = i;
 
       material[color] += pieceVal[piece];
+      psq[MG] += pieceSquare[MG][piece][i];
+      psq[EG] += pieceSquare[EG][piece][i];
+      pieceIndex[i] = pieceNum[piece];
       pieceList[piece][pieceNum[piece]++] = i;
     }
   }
@@ -198,6 +291,8 @@ void Board::check() const {
   int t_majPiece[2]  = {0, 0};
   int t_minPiece[2]  = {0, 0};
   int t_material[2]  = {0, 0};
+  int t_psq[2]       = {0, 0};
+  size_t t_pawnKey   = 0ull;
 
   unsigned char sq64, t_piece, t_Piece_num, sq120, colour, pcount;
 
@@ -212,6 +307,7 @@ void Board::check() const {
     for (t_Piece_num = 0; t_Piece_num < pieceNum[t_piece]; ++t_Piece_num) {
       sq120 = pieceList[t_piece][t_Piece_num];
       assert(board[sq120] == t_piece);
+      assert(pieceIndex[sq120] == t_Piece_num);
     }
   }
 
@@ -231,6 +327,11 @@ void Board::check() const {
         t_minPiece[colour]++;
     }
     t_material[colour] += pieceVal[t_piece];
+    t_psq[MG] += pieceSquare[MG][t_piece][sq120];
+    t_psq[EG] += pieceSquare[EG][t_piece][sq120];
+
+    if (pieceP[t_piece])
+      t_pawnKey ^= pieceKeys[t_piece][sq120];
   }
 
   for (t_piece = wP; t_piece <= bK; ++t_piece)
@@ -263,9 +364,34 @@ void Board::check() const {
            (board[convert64To120(sq64)] == wP));
   }
 
+  // Checking piece and occupancy bitboards
+  size_t t_colorBB[3] = {0ull, 0ull, 0ull};
+
+  for (t_piece = wP; t_piece <= bK; ++t_piece) {
+    size_t t_pieceBB = pieceBB[t_piece];
+
+    pcount = std::popcount(t_pieceBB);
+    assert(pcount == pieceNum[t_piece]);
+
+    t_colorBB[pieceCol[t_piece]] |= t_pieceBB;
+
+    while (t_pieceBB) {
+      sq64 = popBit(t_pieceBB);
+      assert(board[convert64To120(sq64)] == t_piece);
+    }
+  }
+
+  assert(pieceBB[EMPTY] == 0ull);
+  assert(t_colorBB[WHITE] == colorBB[WHITE] &&
+         t_colorBB[BLACK] == colorBB[BLACK]);
+  assert((colorBB[WHITE] | colorBB[BLACK]) == colorBB[BOTH]);
+  assert((colorBB[WHITE] & colorBB[BLACK]) == 0ull);
+
   assert(t_material[WHITE] == material[WHITE] &&
          t_material[BLACK] == material[BLACK]);
 
+  assert(t_psq[MG] == psq[MG] && t_psq[EG] == psq[EG]);
+
   assert(t_minPiece[WHITE] == minPiece[WHITE] &&
          t_minPiece[BLACK] == minPiece[BLACK]);
 
@@ -277,6 +403,7 @@ void Board::check() const {
 
   assert(side == WHITE || side == BLACK);
   assert(generate() == posKey);
+  assert(t_pawnKey == pawnKey);
 
   assert(enPas == NO_SQ ||
          (bRanks[enPas] == RANK_6 && side == WHITE) ||
@@ -290,96 +417,21 @@ void Board::check() const {
 }
 
 bool Board::isAttacked(const unsigned char sq, const Color side_) const {
-  // Pawns
-  if (side_ == WHITE) {
-    if (board[sq - 11] == wP || board[sq - 9] == wP)
-      return true;
-  } else if (board[sq + 11] == bP || board[sq + 9] == bP)
-    return true;
-
-  // Knights
-  for (auto knight : knightMoves) {
-    unsigned char piece = board[sq + knight];
-    if (piece != OFFBOARD && (piece == wN || piece == bN) &&
-        pieceCol[piece] == side_)
-      return true;
-  }
+  return isSquareAttacked(pieceBB, colorBB[BOTH], convert120To64(sq), side_);
+}
 
-  // Diagonal direction (Bishops and Queens)
-  auto checkBQ = [&](char curr) -> int {
-    if (board[curr] == EMPTY)
-      return -1;
-    if (board[curr] == OFFBOARD)
-      return 0;
-    if ((board[curr] == wQ || board[curr] == wB ||
-         board[curr] == bQ || board[curr] == bB) &&
-        pieceCol[board[curr]] == side_)
-      return 1;
-    return 0;
-  };
-
-  unsigned char curr = sq;
-  char tmp = 11;
-
-  while (true) {
-    curr += tmp;
-    char res = checkBQ(curr);
-
-    if (res == 0) {
-      curr = sq;
-
-      if (tmp == 11)       // Change direction
-        tmp = -11;
-      else if (tmp == -11) // Change direction
-        tmp = 9;
-      else if (tmp == 9)   // Change direction
-        tmp = -9;
-      else
-        break;
-    } else if (res == 1)
-      return true;
-  }
+size_t Board::attackersTo(const unsigned char sq, const size_t occupied) const {
+  return squareAttackers(pieceBB, occupied, convert120To64(sq)) & occupied;
+}
 
-  // Horizontal directions (Rooks and Queens)
-  auto checkRQ = [&](int curr) -> int {
-    if (board[curr] == EMPTY)
-      return -1;
-    if (board[curr] == OFFBOARD)
-      return 0;
-    if ((board[curr] == wQ || board[curr] == wR || board[curr] == bQ ||
-         board[curr] == bR) &&
-        pieceCol[board[curr]] == side_)
-      return 1;
-    return 0;
-  };
-
-  curr = sq, tmp = 1;
-
-  while (true) {
-    curr += tmp;
-    char res = checkRQ(curr);
-
-    if (res == 0) {
-      curr = sq;
-
-      if (tmp == 1)       // Change direction
-        tmp = -1;
-      else if (tmp == -1) // Change direction
-        tmp = 10;
-      else if (tmp == 10) // Change direction
-        tmp = -10;
-      else
-        break;
-    } else if (res == 1)
-      return true;
-  }
+bool Board::isRepetition() const {
+  // Positions with the same side to move, which are not older than
+  // the last irreversible move
+  int first = std::max(0, static_cast<int>(hisPly) - fiftyMove);
 
-  for (auto king : kingMoves) {
-    unsigned char piece = board[sq + king];
-    if (piece != OFFBOARD && (piece == wK || piece == bK) &&
-        pieceCol[piece] == side_)
+  for (int i = static_cast<int>(hisPly) - 2; i >= first; i -= 2)
+    if (history[i].getPosKey() == posKey)
       return true;
-  }
 
-  return 0;
+  return false;
 }
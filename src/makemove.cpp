@@ -1,7 +1,7 @@
 // Licensed after GNU GPL v3
 
 #include <cassert>
-#include <algorithm>
+#include <utility>
 
 #include "board.hpp"
 #include "valid.hpp"
@@ -20,8 +20,17 @@ void Board::clearPiece(const unsigned char sq) {
   Color col = pieceCol[piece];
   assert(isSideValid(col));
 
+  if (accumulators)
+    accumulators->clearPiece(*this, piece, sq);
+
   board[sq] = EMPTY;
   material[col] -= pieceVal[piece];
+  psq[MG] -= pieceSquare[MG][piece][sq];
+  psq[EG] -= pieceSquare[EG][piece][sq];
+
+  clearBit(pieceBB[piece],  convert120To64(sq));
+  clearBit(colorBB[col],    convert120To64(sq));
+  clearBit(colorBB[BOTH],   convert120To64(sq));
 
   if (pieceBig[piece]) {
     --bigPiece[col];
@@ -35,14 +44,13 @@ void Board::clearPiece(const unsigned char sq) {
     clearBit(pawns[BOTH], convert120To64(sq));
   }
 
-  auto it = std::find_if(pieceList[piece].begin(), pieceList[piece].end(),
-                         [&sq](auto square) { return square == sq; });
-  assert(it != pieceList[piece].end());
+  // The last piece of the list takes the place of removed one
+  unsigned char index = pieceIndex[sq];
+  assert(index < pieceNum[piece] && pieceList[piece][index] == sq);
 
-  auto diff = std::distance(pieceList[piece].begin(), it);
-  assert(0 <= diff && diff < 10);
-
-  pieceList[piece][diff] = pieceList[piece][--pieceNum[piece]];
+  unsigned char last = pieceList[piece][--pieceNum[piece]];
+  pieceList[piece][index] = last;
+  pieceIndex[last] = index;
 }
 
 void Board::addPiece(const unsigned char sq, const unsigned char piece) {
@@ -54,8 +62,17 @@ void Board::addPiece(const unsigned char sq, const unsigned char piece) {
   Color col = pieceCol[piece];
   assert(isSideValid(col));
 
+  if (accumulators)
+    accumulators->addPiece(*this, piece, sq);
+
   board[sq] = piece;
   material[col] += pieceVal[piece];
+  psq[MG] += pieceSquare[MG][piece][sq];
+  psq[EG] += pieceSquare[EG][piece][sq];
+
+  setBit(pieceBB[piece],  convert120To64(sq));
+  setBit(colorBB[col],    convert120To64(sq));
+  setBit(colorBB[BOTH],   convert120To64(sq));
 
   if (pieceBig[piece]) {
     ++bigPiece[col];
@@ -69,6 +86,7 @@ void Board::addPiece(const unsigned char sq, const unsigned char piece) {
     setBit(pawns[BOTH], convert120To64(sq));
   }
 
+  pieceIndex[sq] = pieceNum[piece];
   pieceList[piece][pieceNum[piece]++] = sq;
 }
 
@@ -82,12 +100,23 @@ void Board::movePiece(const unsigned char from, const unsigned char to) {
   Color col = pieceCol[piece];
   assert(isSideValid(col));
 
+  if (accumulators)
+    accumulators->movePiece(*this, piece, from, to);
+
   hashPiece(piece, from);
   board[from] = EMPTY;
 
   hashPiece(piece, to);
   board[to] = piece;
 
+  psq[MG] += pieceSquare[MG][piece][to] - pieceSquare[MG][piece][from];
+  psq[EG] += pieceSquare[EG][piece][to] - pieceSquare[EG][piece][from];
+
+  size_t fromTo = setMask[convert120To64(from)] | setMask[convert120To64(to)];
+  pieceBB[piece] ^= fromTo;
+  colorBB[col]   ^= fromTo;
+  colorBB[BOTH]  ^= fromTo;
+
   if (!pieceBig[piece]) { // if piece is pawn
     clearBit(pawns[col],  convert120To64(from));
     clearBit(pawns[BOTH], convert120To64(from));
@@ -95,31 +124,34 @@ void Board::movePiece(const unsigned char from, const unsigned char to) {
     setBit(pawns[BOTH], convert120To64(to));
   }
 
-  auto it = std::find_if(pieceList[piece].begin(), pieceList[piece].end(),
-                         [&from](auto elt) { return elt == from; });
+  unsigned char index = pieceIndex[from];
+  assert(index < pieceNum[piece] && pieceList[piece][index] == from);
 
-  assert(it != pieceList[piece].end());
-
-  auto i = std::distance(pieceList[piece].begin(), it);
-
-  pieceList[piece][i] = to; // maybe change to it = to;????
+  pieceList[piece][index] = to;
+  pieceIndex[to] = index;
 }
 
-void Board::takeBackMove() {
+template <Color Us>
+void Board::undoMove() {
   check();
 
-  Color original_side = side;
+  constexpr Color them = Color(Us ^ 1);
 
   --hisPly;
   --ply;
 
-  move::Undo& last_move = history.back();
-  history.pop_back();
+  const move::Undo& last_move = history[hisPly];
   move::Move move = last_move.getMove();
 
+  // The accumulator of the previous position is still on the stack,
+  // pieces go back without touching it
+  nnue::AccumulatorStack *acc = std::exchange(accumulators, nullptr);
+  if (acc)
+    acc->pop();
+
   unsigned char from     = move.getFrom(),
                 to       = move.getTo(),
-                captured = move.getCaptured(),
+                captured = last_move.getCaptured(),
                 promoted = move.getPromoted();
 
   assert(isOnBoard(to));
@@ -137,28 +169,23 @@ void Board::takeBackMove() {
     hashEnPas();
   hashCastle();
 
-  side = Color(side ^ 1);
+  side = Us;
   hashSide();
 
   if (move.getCastle()) {
-    if (to == C1)
-      movePiece(D1, A1);
-    else if (to == C8)
-      movePiece(D8, A8);
-    else if (to == G1)
-      movePiece(F1, H1);
-    else if (to == G8)
-      movePiece(F8, H8);
+    assert(to == (Us == WHITE ? C1 : C8) || to == (Us == WHITE ? G1 : G8));
+    if (to == (Us == WHITE ? C1 : C8))
+      movePiece(Us == WHITE ? D1 : D8, Us == WHITE ? A1 : A8);
     else
-      assert(false);
+      movePiece(Us == WHITE ? F1 : F8, Us == WHITE ? H1 : H8);
   }
   else if (move.getEnPas())
-    addPiece(to + (side == WHITE ? -10 : 10), (side == WHITE ? bP : wP));
+    addPiece(to + (Us == WHITE ? -10 : 10), (them == WHITE ? wP : bP));
 
   movePiece(to, from);
 
   if (pieceK[getPiece(from)])
-    (side == WHITE ? kings.first : kings.second) = from;
+    (Us == WHITE ? kings.first : kings.second) = from;
 
   if (captured != EMPTY) {
     assert(isPieceValid(captured));
@@ -168,13 +195,16 @@ void Board::takeBackMove() {
   if (promoted != EMPTY) {
     assert(isPieceValid(promoted) && !pieceP[promoted]);
     clearPiece(from);
-    addPiece(from, (pieceCol[promoted] == WHITE ? wP : bP));
+    addPiece(from, (Us == WHITE ? wP : bP));
   }
 
+  accumulators = acc;
+
   check();
 }
 
-bool Board::makeMove(const move::Move& move) {
+template <Color Us>
+void Board::doMove(const move::Move& move) {
   check();
 
   unsigned char from     = move.getFrom(),
@@ -187,22 +217,23 @@ bool Board::makeMove(const move::Move& move) {
   assert(isPieceValid(getPiece(from)));
 
 
-  history.emplace_back(move, castlePerm, enPas, fiftyMove, posKey);
+  assert(hisPly < maxGameMoves);
+  history[hisPly] = move::Undo(move, castlePerm, enPas, fiftyMove, posKey);
+
+  if (accumulators)
+    accumulators->push(*this);
+
+  assert(side == Us);
 
   if (move.getCastle()) {
-    if (to == C1)
-      movePiece(A1, D1);
-    else if (to == C8)
-      movePiece(A8, D8);
-    else if (to == G1)
-      movePiece(H1, F1);
-    else if (to == G8)
-      movePiece(H8, F8);
+    assert(to == (Us == WHITE ? C1 : C8) || to == (Us == WHITE ? G1 : G8));
+    if (to == (Us == WHITE ? C1 : C8))
+      movePiece(Us == WHITE ? A1 : A8, Us == WHITE ? D1 : D8);
     else
-      assert(false);
+      movePiece(Us == WHITE ? H1 : H8, Us == WHITE ? F1 : F8);
   }
   else if (move.getEnPas())
-    clearPiece(to + (side == WHITE ? -10 : 10));
+    clearPiece(to + (Us == WHITE ? -10 : 10));
 
   if (enPas != NO_SQ)
     hashEnPas();
@@ -227,8 +258,8 @@ bool Board::makeMove(const move::Move& move) {
   if (pieceP[getPiece(from)]) {
     fiftyMove = 0;
     if (move.getPawnStart()) {
-      enPas = Cell(from + (side == WHITE ? 10 : -10));
-      assert(bRanks[enPas] == (side == WHITE ? RANK_3 : RANK_6));
+      enPas = Cell(from + (Us == WHITE ? 10 : -10));
+      assert(bRanks[enPas] == (Us == WHITE ? RANK_3 : RANK_6));
       hashEnPas();
     }
   }
@@ -242,17 +273,39 @@ bool Board::makeMove(const move::Move& move) {
   }
 
   if (pieceK[getPiece(to)])
-    (side == WHITE ? kings.first : kings.second) = to;
+    (Us == WHITE ? kings.first : kings.second) = to;
 
-  side = Color(side ^ 1);
+  side = Color(Us ^ 1);
   hashSide();
 
   check();
+}
+
+void Board::takeBackMove() {
+  // Move was made by the opposite side
+  side == WHITE ? undoMove<BLACK>() : undoMove<WHITE>();
+}
+
+bool Board::makeMove(const move::Move& move) {
+  if (history_full())
+    return false;
 
-  if (isAttacked(((side ^ 1) == WHITE ? kings.first : kings.second), side)) {
+  side == WHITE ? doMove<WHITE>(move) : doMove<BLACK>(move);
+
+  if (isAttacked(getKing(Color(side ^ 1)), side)) {
     takeBackMove();
     return false;
   }
 
   return true;
 }
+
+bool Board::makeLegalMove(const move::Move& move) {
+  if (history_full())
+    return false;
+
+  side == WHITE ? doMove<WHITE>(move) : doMove<BLACK>(move);
+
+  assert(!isAttacked(getKing(Color(side ^ 1)), side));
+  return true;
+}
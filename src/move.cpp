@@ -1,9 +1,12 @@
 // Licensed after GNU GPL v3
 
+#include "attacks.hpp"
 #include "move.hpp"
 #include "board.hpp"
+#include "position.hpp"
 
 #include <algorithm>
+#include <bit>
 
 using namespace move;
 
@@ -14,9 +17,8 @@ constexpr unsigned pawn_start = 0x80000;
 constexpr unsigned castle = 0x1000000;
 } // anonymous namespace
 
-std::string Move::getDumpMove() {
-#if defined(DEBUG_ONLY)
-  dump_str.clear();
+std::string Move::getDumpMove() const {
+  std::string dump_str;
 
   unsigned char ff = bFiles[getFrom()];
   unsigned char rf = bRanks[getFrom()];
@@ -43,12 +45,21 @@ std::string Move::getDumpMove() {
   }
 
   return dump_str;
-#else
-  return "";
-#endif
 }
 
 
+Move MoveList::pickBest(const size_t i) {
+  assert(i < count);
+
+  auto best = std::max_element(moves.begin() + i, moves.begin() + count,
+                               [](const Move &lhs, const Move &rhs) {
+                                 return lhs.getScore() < rhs.getScore();
+                               });
+  std::swap(moves[i], *best);
+
+  return moves[i];
+}
+
 void MoveList::dump(std::ostream& os) const {
 #if defined(DEBUG_ONLY)
   os << "MoveList: \n";
@@ -61,165 +72,474 @@ void MoveList::dump(std::ostream& os) const {
 #endif
 }
 
-void MoveList::AddQuietMove(const board::Board & b, Move && m) {
-  push_back(m);
+namespace {
+// Pieces of `side` attacking the square `sq64` when squares of
+// `occupied` bitboard are occupied
+template <Color side, typename Pos>
+size_t attackersOf(const Pos &b, const unsigned char sq64,
+                   const size_t occupied) {
+  constexpr bool white = side == WHITE;
+  return (pawnAttacks[side ^ 1][sq64] & b.getPieceBB(white ? wP : bP)) |
+         (knightAttacks[sq64]       & b.getPieceBB(white ? wN : bN)) |
+         (kingAttacks[sq64]         & b.getPieceBB(white ? wK : bK)) |
+         (bishopAttacks(sq64, occupied) & (b.getPieceBB(white ? wB : bB) |
+                                           b.getPieceBB(white ? wQ : bQ))) |
+         (rookAttacks(sq64, occupied)   & (b.getPieceBB(white ? wR : bR) |
+                                           b.getPieceBB(white ? wQ : bQ)));
+}
+
+// Pieces giving check to the king of `Us` and, if `Pins`, pieces of `Us`
+// pinned to it. `target` - squares where pieces other than king may go:
+// the checker and squares between it and king, everything if not in check
+struct KingSafety {
+  size_t checkers = 0ull,
+         target   = ~0ull,
+         pinned   = 0ull;
+};
+
+template <Color Us, bool Pins, typename Pos>
+KingSafety kingSafety(const Pos &b, const unsigned char king64,
+                      const size_t occupied) {
+  constexpr Color them = Color(Us ^ 1);
+  constexpr bool white = them == WHITE;
+
+  KingSafety ks;
+  ks.checkers = attackersOf<them>(b, king64, occupied);
+
+  if (ks.checkers)
+    ks.target = ks.checkers | betweenBB[king64][std::countr_zero(ks.checkers)];
+
+  if constexpr (Pins) {
+    size_t snipers =
+        (rookAttacks(king64, 0ull) & (b.getPieceBB(white ? wR : bR) |
+                                      b.getPieceBB(white ? wQ : bQ))) |
+        (bishopAttacks(king64, 0ull) & (b.getPieceBB(white ? wB : bB) |
+                                        b.getPieceBB(white ? wQ : bQ)));
+
+    while (snipers) {
+      size_t between = betweenBB[king64][popBit(snipers)] & occupied;
+      if (std::has_single_bit(between) && (between & b.getColorBB(Us)))
+        ks.pinned |= between;
+    }
+  }
+
+  return ks;
+}
+
+// En passant removes two pieces from the same rank, so the legality
+// is checked on the position after the capture
+template <Color Us, typename Pos>
+bool legalEnPas(const Pos &b, const unsigned char from64,
+                const unsigned char to, const unsigned char king64) {
+  size_t captured = setMask[convert120To64(to + (Us == WHITE ? -10 : 10))];
+  size_t after = (b.getColorBB(BOTH) ^ setMask[from64] ^ captured) |
+                 setMask[convert120To64(to)];
+  return !(attackersOf<Color(Us ^ 1)>(b, king64, after) & ~captured);
+}
+
+// Castling rights, empty squares and squares the king passes,
+// it is impossible while in check.
+// Pseudo-legal mode leaves the check of the king's final square to makeMove
+template <Color Us, bool KingSide, bool Legal, typename Pos>
+bool canCastle(const Pos &b) {
+  constexpr Color them = Color(Us ^ 1);
+  constexpr bool white = Us == WHITE;
+
+  if constexpr (KingSide)
+    return (b.getCastlePerm() & (white ? WKC : BKC)) &&
+           b.getPiece(white ? F1 : F8) == EMPTY &&
+           b.getPiece(white ? G1 : G8) == EMPTY &&
+           !b.isAttacked(white ? E1 : E8, them) &&
+           !b.isAttacked(white ? F1 : F8, them) &&
+           !(Legal && b.isAttacked(white ? G1 : G8, them));
+  else
+    return (b.getCastlePerm() & (white ? WQC : BQC)) &&
+           b.getPiece(white ? D1 : D8) == EMPTY &&
+           b.getPiece(white ? C1 : C8) == EMPTY &&
+           b.getPiece(white ? B1 : B8) == EMPTY &&
+           !b.isAttacked(white ? E1 : E8, them) &&
+           !b.isAttacked(white ? D1 : D8, them) &&
+           !(Legal && b.isAttacked(white ? C1 : C8, them));
+}
+
+// Writes generated moves one after another starting from `list`,
+// `Pos` is board::Board or board::Position
+template <typename Pos>
+class Generator {
+  const Pos &b;
+  Move *last;
+
+  // Most valuable victim first, then least valuable attacker,
+  // the promoted piece counts as a part of the victim
+  unsigned mvvLva(const Move &m, const unsigned char victim) const {
+    return (pieceVal[victim] + pieceVal[m.getPromoted()]) * 8 -
+           (b.getPiece(m.getFrom()) - 1) % 6; // P, N, B, R, Q, K
+  }
+
+  void AddQuietMove(Move &&m);
+  void AddCapturedMove(Move &&m);
+  void AddEnPasMove(Move &&m);
+  template <Color side>
+  void AddPawnMove(Move &&m, bool captured);
+
+  // Generation for the side to move known at compile time
+  template <Color Us, GenType Type, bool Legal>
+  Move *generate();
+
+public:
+  Generator(const Pos &b, Move *list) : b(b), last(list) {}
+
+  // Legal == true => only legal moves are generated
+  template <GenType Type, bool Legal>
+  Move *generate() {
+    return b.getSide() == WHITE ? generate<WHITE, Type, Legal>()
+                                : generate<BLACK, Type, Legal>();
+  }
+};
+
+// Quiet moves get score 0, the search orders them by its own tables.
+// Quiet promotions are scored as captures of nothing
+template <typename Pos>
+void Generator<Pos>::AddQuietMove(Move &&m) {
+  if (m.getPromoted() != EMPTY)
+    m.SetScore(mvvLva(m, EMPTY));
+  *last++ = m;
 }
 
-void MoveList::AddCapturedMove(const board::Board& b, Move&& m) {
-  push_back(m);
+template <typename Pos>
+void Generator<Pos>::AddCapturedMove(Move &&m) {
+  m.SetScore(mvvLva(m, m.getCaptured()));
+  *last++ = m;
 }
 
-void MoveList::AddEnPasMove(const board::Board& b, Move&& m) {
-  push_back(m);
+template <typename Pos>
+void Generator<Pos>::AddEnPasMove(Move &&m) {
+  m.SetScore(mvvLva(m, wP));
+  *last++ = m;
 }
 
-void MoveList::AddPawnMove(const board::Board& b, Move&& m, bool captured) {
+template <typename Pos>
+template <Color side>
+void Generator<Pos>::AddPawnMove(Move &&m, bool captured) {
   unsigned char from = m.getFrom(),
                 to   = m.getTo(),
                 cap  = captured ? m.getCaptured() : EMPTY;
-  Color side = b.getSide();
 
   if (captured) {
     if (bRanks[m.getFrom()] == (side == WHITE ? RANK_7 : RANK_2)) {
-      AddCapturedMove(b, Move(from, to, cap, (side == WHITE ? wQ : bQ)));
-      AddCapturedMove(b, Move(from, to, cap, (side == WHITE ? wR : bR)));
-      AddCapturedMove(b, Move(from, to, cap, (side == WHITE ? wB : bB)));
-      AddCapturedMove(b, Move(from, to, cap, (side == WHITE ? wN : bN)));
+      AddCapturedMove(Move(from, to, cap, (side == WHITE ? wQ : bQ)));
+      AddCapturedMove(Move(from, to, cap, (side == WHITE ? wR : bR)));
+      AddCapturedMove(Move(from, to, cap, (side == WHITE ? wB : bB)));
+      AddCapturedMove(Move(from, to, cap, (side == WHITE ? wN : bN)));
     }
     else
-      AddCapturedMove(b, Move(from, to, cap));
+      AddCapturedMove(Move(from, to, cap));
   }
   else {
     if (bRanks[m.getFrom()] == (side == WHITE ? RANK_7 : RANK_2)) {
-      AddQuietMove(b, Move(from, to, cap, (side == WHITE ? wQ : bQ)));
-      AddQuietMove(b, Move(from, to, cap, (side == WHITE ? wR : bR)));
-      AddQuietMove(b, Move(from, to, cap, (side == WHITE ? wB : bB)));
-      AddQuietMove(b, Move(from, to, cap, (side == WHITE ? wN : bN)));
+      AddQuietMove(Move(from, to, cap, (side == WHITE ? wQ : bQ)));
+      AddQuietMove(Move(from, to, cap, (side == WHITE ? wR : bR)));
+      AddQuietMove(Move(from, to, cap, (side == WHITE ? wB : bB)));
+      AddQuietMove(Move(from, to, cap, (side == WHITE ? wN : bN)));
     }
     else
-      AddQuietMove(b, Move(from, to));
+      AddQuietMove(Move(from, to));
   }
 }
 
-void MoveList::generateAllMoves(const board::Board& b) {
+template <typename Pos>
+template <Color Us, GenType Type, bool Legal>
+Move *Generator<Pos>::generate() {
   b.check();
 
-  unsigned char piece = EMPTY;
+  // Which part of moves goes to the list
+  constexpr bool genCaptures = Type != QUIETS,
+                 genQuiets   = Type != CAPTURES,
+                 genCheck    = Legal || Type == EVASIONS;
 
-  Color side       = b.getSide(),
-        other_side = Color(side ^ 1); // WHITE == BLACK ^ 1
+  constexpr Color side       = Us,
+                  other_side = Color(Us ^ 1); // WHITE == BLACK ^ 1
 
-  char shift_9    = (side == WHITE ?      9 :     -9),
+  constexpr char
+       shift_9    = (side == WHITE ?      9 :     -9),
        shift_10   = (side == WHITE ?     10 :    -10),
        shift_11   = (side == WHITE ?     11 :    -11),
        shift_20   = (side == WHITE ?     20 :    -20);
   
-  unsigned char
+  constexpr unsigned char
        shift_rank = (side == WHITE ? RANK_2 : RANK_7),
        shift_pawn = (side == WHITE ?     wP :     bP),
-       shift_f    = (side == WHITE ?     F1 :     F8),
        shift_g    = (side == WHITE ?     G1 :     G8),
        shift_e    = (side == WHITE ?     E1 :     E8),
-       shift_d    = (side == WHITE ?     D1 :     D8),
-       shift_c    = (side == WHITE ?     C1 :     C8),
-       shift_b    = (side == WHITE ?     B1 :     B8);
+       shift_c    = (side == WHITE ?     C1 :     C8);
+
+  size_t enemies  = b.getColorBB(other_side),
+         occupied = b.getColorBB(BOTH),
+         empty    = ~occupied;
+
+  // Squares where captures and quiet moves may end
+  size_t captureMask = genCaptures ? enemies : 0ull,
+         quietMask   = genQuiets   ? empty   : 0ull;
+
+  unsigned char king   = b.getKing(side),
+                king64 = convert120To64(king);
+
+  // In legal mode and for evasions:
+  // `target` - squares where pieces other than king may go,
+  // if king is in check these are the checker and squares between it and king
+  // In legal mode only:
+  // `pinned` - pieces which can move only along the line to their king
+  size_t target   = ~0ull,
+         pinned   = 0ull,
+         checkers = 0ull;
+
+  if constexpr (genCheck) {
+    KingSafety ks = kingSafety<side, Legal>(b, king64, occupied);
+    checkers = ks.checkers;
+    target   = ks.target;
+    pinned   = ks.pinned;
+  }
+
+  // Squares where piece from `sq64` may go without leaving king in check
+  auto allowed = [target, pinned, king64](unsigned char sq64) {
+    return pinned & setMask[sq64] ? target & lineBB[king64][sq64] : target;
+  };
+
+  // King
+  size_t kingTargets = kingAttacks[king64] & (captureMask | quietMask);
+
+  while (kingTargets) {
+    unsigned char target64 = popBit(kingTargets),
+                  target_sq = convert64To120(target64);
+
+    // King mustn't hide from the slider behind itself
+    if (Legal && attackersOf<other_side>(b, target64,
+                                         occupied ^ setMask[king64]))
+      continue;
+
+    if (enemies & setMask[target64])
+      AddCapturedMove(Move(king, target_sq, b.getPiece(target_sq)));
+    else
+      AddQuietMove(Move(king, target_sq));
+  }
+
+  // Only king can escape from double check
+  if (genCheck && std::popcount(checkers) > 1)
+    return last;
 
   // Pawns
-  for (unsigned char piece_num = 0; piece_num < b.getPieceNum(shift_pawn); ++piece_num) {
-    unsigned char sq = b.getPieceListSq(shift_pawn, piece_num);
+  for (size_t pawns = b.getPieceBB(shift_pawn); pawns;) {
+    unsigned char sq64 = popBit(pawns),
+                  sq   = convert64To120(sq64);
+    size_t pawnTarget = allowed(sq64);
+
+    // Promotions go together with captures
+    bool promotion = bRanks[sq + shift_10] == (side == WHITE ? RANK_8 : RANK_1);
 
     if (b.getPiece(sq + shift_10) == EMPTY) {
-      AddPawnMove(b, Move(sq, sq + shift_10), false);
-      if (bRanks[sq] == shift_rank && b.getPiece(sq + shift_20) == EMPTY)
-        AddQuietMove(b, Move(sq, sq + shift_20, EMPTY, EMPTY, pawn_start));
+      if ((promotion ? genCaptures : genQuiets) &&
+          (pawnTarget & setMask[convert120To64(sq + shift_10)]))
+        AddPawnMove<side>(Move(sq, sq + shift_10), false);
+      if (genQuiets && bRanks[sq] == shift_rank &&
+          b.getPiece(sq + shift_20) == EMPTY &&
+          (pawnTarget & setMask[convert120To64(sq + shift_20)]))
+        AddQuietMove(Move(sq, sq + shift_20, EMPTY, EMPTY, pawn_start));
     }
 
-    if (bRanks[sq + shift_9] != OFFBOARD &&
-        pieceCol[b.getPiece(sq + shift_9)] == other_side)
-      AddPawnMove(b, Move(sq, sq + shift_9, b.getPiece(sq + shift_9)), true);
+    size_t captures = pawnAttacks[side][sq64] & captureMask & pawnTarget;
 
-    if (bRanks[sq + shift_11] != OFFBOARD &&
-        pieceCol[b.getPiece(sq + shift_11)] == other_side)
-      AddPawnMove(b, Move(sq, sq + shift_11, b.getPiece(sq + shift_11)), true);
+    while (captures) {
+      unsigned char target_sq = convert64To120(popBit(captures));
+      AddPawnMove<side>(Move(sq, target_sq, b.getPiece(target_sq)), true);
+    }
 
-    if (b.getEnPas() != NO_SQ) {
-      if (sq + shift_9 == b.getEnPas())
-        AddEnPasMove(b, Move(sq, sq + shift_9, EMPTY, EMPTY, en_pas));
+    if (genCaptures && b.getEnPas() != NO_SQ) {
+      auto enPasAllowed = [&](unsigned char to) {
+        return !Legal || legalEnPas<side>(b, sq64, to, king64);
+      };
 
-      if (sq + shift_11 == b.getEnPas())
-        AddEnPasMove(b, Move(sq, sq + shift_11, EMPTY, EMPTY, en_pas));
+      if (sq + shift_9 == b.getEnPas() && enPasAllowed(sq + shift_9))
+        AddEnPasMove(Move(sq, sq + shift_9, EMPTY, EMPTY, en_pas));
+
+      if (sq + shift_11 == b.getEnPas() && enPasAllowed(sq + shift_11))
+        AddEnPasMove(Move(sq, sq + shift_11, EMPTY, EMPTY, en_pas));
     }
   }
 
   // Castling
-  if (((b.getCastlePerm()) & (side == WHITE ? WKC : BKC)) &&
-      b.getPiece(shift_f) == EMPTY &&
-      b.getPiece(shift_g) == EMPTY &&
-      !b.isAttacked(shift_e, other_side) &&
-      !b.isAttacked(shift_f, other_side))
-    AddQuietMove(b, Move(shift_e, shift_g, EMPTY, EMPTY, castle));
-
-  if (((b.getCastlePerm()) & (side == WHITE ? WQC : BQC)) &&
-      b.getPiece(shift_d) == EMPTY &&
-      b.getPiece(shift_c) == EMPTY &&
-      b.getPiece(shift_b) == EMPTY &&
-      !b.isAttacked(shift_e, other_side) &&
-      !b.isAttacked(shift_d, other_side))
-    AddQuietMove(b, Move(shift_e, shift_c, EMPTY, EMPTY, castle));
-
-  // Slide pieces
-  static constexpr std::array<Piece, 3> loop_slide_piece_w{wB, wR, wQ};
-  static constexpr std::array<Piece, 3> loop_slide_piece_b{bB, bR, bQ};
-  
-  auto loop_slide_piece = (side == WHITE ? loop_slide_piece_w : loop_slide_piece_b);
-
-  std::for_each(loop_slide_piece.begin(), loop_slide_piece.end(), [this, &b, other_side](auto piece) {
-    for (int piece_num = 0; piece_num < b.getPieceNum(piece); ++piece_num) {
-      unsigned char sq = b.getPieceListSq(piece, piece_num);
-      for (int i = 0; i < directionNumber[piece]; ++i) {
-        char dir = pieceDirections[piece][i];
-        unsigned char target_sq = sq + dir;
-
-        for (unsigned char target_piece = b.getPiece(target_sq);
-             target_piece != OFFBOARD;
-             target_sq += dir, target_piece = b.getPiece(target_sq)) {
-          if (target_piece != EMPTY) {
-            if (pieceCol[target_piece] == other_side)
-              AddCapturedMove(b, Move(sq, target_sq, b.getPiece(target_sq)));
-            break;
-          }
-          AddQuietMove(b, Move(sq, target_sq));
-        }
+  if constexpr (Type == QUIETS || Type == ALL) {
+    if (canCastle<side, true, Legal>(b))
+      AddQuietMove(Move(shift_e, shift_g, EMPTY, EMPTY, castle));
+
+    if (canCastle<side, false, Legal>(b))
+      AddQuietMove(Move(shift_e, shift_c, EMPTY, EMPTY, castle));
+  }
+
+  // Non-slide and slide pieces, `attacksOf` gives attacked squares
+  // of the piece standing on the square of 64 squares board
+  auto addPieceMoves = [this, captureMask, quietMask,
+                        &allowed](size_t pieces, auto attacksOf) {
+    while (pieces) {
+      unsigned char sq64 = popBit(pieces),
+                    sq   = convert64To120(sq64);
+
+      size_t attacks  = attacksOf(sq64) & allowed(sq64),
+             captures = attacks & captureMask,
+             quiets   = attacks & quietMask;
+
+      while (captures) {
+        unsigned char target_sq = convert64To120(popBit(captures));
+        AddCapturedMove(Move(sq, target_sq, b.getPiece(target_sq)));
       }
+
+      while (quiets)
+        AddQuietMove(Move(sq, convert64To120(popBit(quiets))));
     }
-  });
+  };
 
-  // Non-slide pieces
-  static constexpr std::array<Piece, 2> loop_piece_w {wN, wK};
-  static constexpr std::array<Piece, 2> loop_piece_b {bN, bK};
+  auto bishop = [occupied](unsigned char sq64) { return bishopAttacks(sq64, occupied); };
+  auto rook   = [occupied](unsigned char sq64) { return rookAttacks(sq64, occupied); };
+  auto queen  = [occupied](unsigned char sq64) { return queenAttacks(sq64, occupied); };
+  auto knight = [](unsigned char sq64) { return knightAttacks[sq64]; };
 
-  auto loop_piece = (side == WHITE ? loop_piece_w : loop_piece_b);
-  
-  std::for_each(loop_piece.begin(), loop_piece.end(), [this, &b, other_side](auto piece) {
-    for (int piece_num = 0; piece_num < b.getPieceNum(piece); ++piece_num) {
-      unsigned char sq = b.getPieceListSq(piece, piece_num);
-
-      for (int i = 0; i < directionNumber[piece]; ++i) {
-        char dir = pieceDirections[piece][i];
-        unsigned char target_sq = sq + dir;
-        unsigned char target_piece = b.getPiece(target_sq);
-
-        if (target_piece == OFFBOARD)
-          continue;
-        else if (target_piece != EMPTY) {
-          if (pieceCol[target_piece] == other_side)
-            AddCapturedMove(b, Move(sq, target_sq, b.getPiece(target_sq)));
-        }
-        else
-          AddQuietMove(b, Move(sq, target_sq));
-      }
+  addPieceMoves(b.getPieceBB(side == WHITE ? wB : bB), bishop);
+  addPieceMoves(b.getPieceBB(side == WHITE ? wR : bR), rook);
+  addPieceMoves(b.getPieceBB(side == WHITE ? wQ : bQ), queen);
+  addPieceMoves(b.getPieceBB(side == WHITE ? wN : bN), knight);
+
+  return last;
+}
+
+// Number of legal moves, nothing is written: targets of every piece
+// are masked with pins and checks and counted with popcount
+template <Color Us, typename Pos>
+size_t countLegal(const Pos &b) {
+  b.check();
+
+  constexpr Color them  = Color(Us ^ 1);
+  constexpr bool  white = Us == WHITE;
+
+  size_t own      = b.getColorBB(Us),
+         enemies  = b.getColorBB(them),
+         occupied = b.getColorBB(BOTH);
+
+  unsigned char king64 = convert120To64(b.getKing(Us));
+
+  KingSafety ks = kingSafety<Us, true>(b, king64, occupied);
+
+  size_t count = 0;
+
+  for (size_t kingTargets = kingAttacks[king64] & ~own; kingTargets;)
+    if (!attackersOf<them>(b, popBit(kingTargets), occupied ^ setMask[king64]))
+      ++count;
+
+  if (std::popcount(ks.checkers) > 1)
+    return count;
+
+  auto allowed = [&ks, king64](unsigned char sq64) {
+    return ks.pinned & setMask[sq64] ? ks.target & lineBB[king64][sq64]
+                                     : ks.target;
+  };
+
+  // Pawns, every promotion is 4 moves
+  for (size_t pawns = b.getPieceBB(white ? wP : bP); pawns;) {
+    unsigned char sq64 = popBit(pawns),
+                  rank = sq64 / 8;
+
+    size_t targets = setMask[sq64 + (white ? 8 : -8)] & ~occupied;
+    if (targets && rank == (white ? RANK_2 : RANK_7))
+      targets |= setMask[sq64 + (white ? 16 : -16)] & ~occupied;
+
+    targets = (targets | (pawnAttacks[Us][sq64] & enemies)) & allowed(sq64);
+    count += std::popcount(targets) << (rank == (white ? RANK_7 : RANK_2) ? 2 : 0);
+
+    if (b.getEnPas() != NO_SQ &&
+        (pawnAttacks[Us][sq64] & setMask[convert120To64(b.getEnPas())]) &&
+        legalEnPas<Us>(b, sq64, b.getEnPas(), king64))
+      ++count;
+  }
+
+  count += canCastle<Us, true, true>(b) + canCastle<Us, false, true>(b);
+
+  auto countPieces = [&](size_t pieces, auto attacksOf) {
+    while (pieces) {
+      unsigned char sq64 = popBit(pieces);
+      count += std::popcount(attacksOf(sq64) & ~own & allowed(sq64));
     }
-  });
+  };
+
+  auto bishop = [occupied](unsigned char sq64) { return bishopAttacks(sq64, occupied); };
+  auto rook   = [occupied](unsigned char sq64) { return rookAttacks(sq64, occupied); };
+  auto queen  = [occupied](unsigned char sq64) { return queenAttacks(sq64, occupied); };
+  auto knight = [](unsigned char sq64) { return knightAttacks[sq64]; };
+
+  countPieces(b.getPieceBB(white ? wB : bB), bishop);
+  countPieces(b.getPieceBB(white ? wR : bR), rook);
+  countPieces(b.getPieceBB(white ? wQ : bQ), queen);
+  countPieces(b.getPieceBB(white ? wN : bN), knight);
+
+  return count;
+}
+} // anonymous namespace
+
+template <GenType Type, bool Legal>
+size_t move::generate(const board::Board &b, std::span<Move, maxMoves> list) {
+  return Generator(b, list.data()).template generate<Type, Legal>() - list.data();
+}
+
+template <GenType Type, bool Legal>
+size_t move::generate(const board::Position &b, std::span<Move, maxMoves> list) {
+  return Generator(b, list.data()).template generate<Type, Legal>() - list.data();
+}
+
+template size_t move::generate<ALL, false>(const board::Board &, std::span<Move, maxMoves>);
+template size_t move::generate<ALL, true>(const board::Board &, std::span<Move, maxMoves>);
+template size_t move::generate<CAPTURES, false>(const board::Board &, std::span<Move, maxMoves>);
+template size_t move::generate<QUIETS, false>(const board::Board &, std::span<Move, maxMoves>);
+template size_t move::generate<EVASIONS, false>(const board::Board &, std::span<Move, maxMoves>);
+template size_t move::generate<ALL, false>(const board::Position &, std::span<Move, maxMoves>);
+template size_t move::generate<ALL, true>(const board::Position &, std::span<Move, maxMoves>);
+
+size_t move::generateAllMoves(const board::Board &b,
+                              std::span<Move, maxMoves> list) {
+  return generate<ALL, false>(b, list);
+}
+
+size_t move::generateLegalMoves(const board::Board &b,
+                                std::span<Move, maxMoves> list) {
+  return generate<ALL, true>(b, list);
+}
+
+size_t move::countLegalMoves(const board::Board &b) {
+  return b.getSide() == WHITE ? countLegal<WHITE>(b) : countLegal<BLACK>(b);
+}
+
+void MoveList::generateAllMoves(const board::Board &b) {
+  count = move::generateAllMoves(b, moves);
+}
+
+void MoveList::generateLegalMoves(const board::Board &b) {
+  count = move::generateLegalMoves(b, moves);
+}
+
+void MoveList::generateAllMoves(const board::Position &p) {
+  count = move::generate<ALL, false>(p, moves);
+}
+
+void MoveList::generateLegalMoves(const board::Position &p) {
+  count = move::generate<ALL, true>(p, moves);
+}
+
+void MoveList::generateCaptures(const board::Board &b) {
+  count = move::generate<CAPTURES, false>(b, moves);
+}
+
+void MoveList::generateQuiets(const board::Board &b) {
+  count = move::generate<QUIETS, false>(b, moves);
+}
+
+void MoveList::generateEvasions(const board::Board &b) {
+  count = move::generate<EVASIONS, false>(b, moves);
 }
 
 
@@ -233,4 +553,4 @@ char* move::getDumpSquare(const int sq) {
   SqStr[1] = '1' + rank;
 
   return SqStr;
-}
\ No newline at end of file
+}
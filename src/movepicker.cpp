@@ -0,0 +1,60 @@
+// Licensed after GNU GPL v3
+
+#include "movepicker.hpp"
+#include "board.hpp"
+
+using namespace move;
+
+MovePicker::MovePicker(const board::Board &b)
+    : b(b), stage(b.inCheck() ? GEN_EVASIONS : GEN_CAPTURES) {}
+
+bool MovePicker::next(Move &m) {
+  while (true) {
+    switch (stage) {
+    case GEN_CAPTURES:
+      list.generateCaptures(b);
+      cur = 0;
+      stage = PICK_CAPTURES;
+      [[fallthrough]];
+
+    case PICK_CAPTURES:
+      if (cur < list.size()) {
+        m = list.pickBest(cur++);
+        return true;
+      }
+      stage = GEN_QUIETS;
+      [[fallthrough]];
+
+    case GEN_QUIETS:
+      list.generateQuiets(b);
+      cur = 0;
+      stage = PICK_QUIETS;
+      [[fallthrough]];
+
+    case PICK_QUIETS:
+      if (cur < list.size()) {
+        m = list[cur++];
+        return true;
+      }
+      stage = FINISHED;
+      return false;
+
+    case GEN_EVASIONS:
+      list.generateEvasions(b);
+      cur = 0;
+      stage = PICK_EVASIONS;
+      [[fallthrough]];
+
+    case PICK_EVASIONS:
+      if (cur < list.size()) {
+        m = list[cur++];
+        return true;
+      }
+      stage = FINISHED;
+      return false;
+
+    case FINISHED:
+      return false;
+    }
+  }
+}
@@ -0,0 +1,362 @@
+// Licensed after GNU GPL v3
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NNUE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(USE_AVX2) || defined(USE_SSE41)
+#include <immintrin.h>
+#endif
+
+#include "board.hpp"
+#include "nnue.hpp"
+#include "search.hpp"
+
+using namespace nnue;
+
+namespace {
+// Pointers to the parts of the mapped file
+struct Network {
+  const int16_t *ftBias, *ftWeights;
+  const int32_t *l1Bias;
+  const int8_t  *l1Weights;
+  const int32_t *l2Bias;
+  const int8_t  *l2Weights;
+  const int32_t *outBias;
+  const int8_t  *outWeights;
+};
+
+// Memory of the loaded network: the mapping of the file or,
+// where mmap isn't available, the file read to the heap
+struct Storage {
+  const char *data = nullptr;
+  std::vector<char> buffer;
+  bool mapped = false;
+
+  ~Storage() { release(); }
+
+  void release() {
+#if defined(NNUE_MMAP)
+    if (mapped)
+      munmap(const_cast<char *>(data), fileSize);
+#endif
+    data = nullptr;
+    mapped = false;
+    buffer.clear();
+  }
+};
+
+Storage storage;
+Network network;
+
+// Usage: featureIndex(perspective, king square, piece, square),
+// squares are of the 120 squares board
+size_t featureIndex(const Color perspective, const unsigned char king,
+                    const unsigned char piece, const unsigned char sq) {
+  // Vertical flip for black, so each side sees itself at the bottom
+  const unsigned char flip = perspective == WHITE ? 0 : 56;
+  const size_t kind = (piece - 1) % 6 + (pieceCol[piece] == perspective ? 0 : 5);
+
+  return (size_t(convert120To64(king) ^ flip) * pieceKinds + kind) *
+             regularNC + (convert120To64(sq) ^ flip);
+}
+
+// accumulator += weights or accumulator -= weights of the feature
+template <bool Add>
+void updateFeature(std::array<int16_t, halfDims> &acc, const size_t feature) {
+  const int16_t *w = network.ftWeights + feature * halfDims;
+
+#if defined(USE_AVX2)
+  for (size_t i = 0; i < halfDims; i += 16) {
+    auto a = _mm256_load_si256(reinterpret_cast<__m256i *>(&acc[i]));
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + i));
+    a = Add ? _mm256_add_epi16(a, b) : _mm256_sub_epi16(a, b);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(&acc[i]), a);
+  }
+#elif defined(USE_SSE41)
+  for (size_t i = 0; i < halfDims; i += 8) {
+    auto a = _mm_load_si128(reinterpret_cast<__m128i *>(&acc[i]));
+    auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i));
+    a = Add ? _mm_add_epi16(a, b) : _mm_sub_epi16(a, b);
+    _mm_store_si128(reinterpret_cast<__m128i *>(&acc[i]), a);
+  }
+#else
+  for (size_t i = 0; i < halfDims; ++i)
+    acc[i] = Add ? acc[i] + w[i] : acc[i] - w[i];
+#endif
+}
+
+// The accumulator of one perspective from scratch
+void refresh(const board::Board &b, Accumulator &acc, const Color perspective) {
+  std::copy(network.ftBias, network.ftBias + halfDims,
+            acc.values[perspective].begin());
+
+  const unsigned char king = b.getKing(perspective);
+
+  for (unsigned char piece = wP; piece <= bK; ++piece) {
+    if (pieceK[piece])
+      continue;
+
+    for (size_t bb = b.getPieceBB(piece); bb;) {
+      unsigned char sq = convert64To120(popBit(bb));
+      updateFeature<true>(acc.values[perspective],
+                          featureIndex(perspective, king, piece, sq));
+    }
+  }
+
+  acc.dirty[perspective] = false;
+}
+
+// Clipped ReLU of int16 values to [0, 127], N is a multiple of 32
+template <size_t N>
+void clippedRelu(const int16_t *in, uint8_t *out) {
+#if defined(USE_AVX2)
+  for (size_t i = 0; i < N; i += 32) {
+    auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 16));
+    // Packing works inside 128 bits lanes, the permutation restores order
+    auto packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0xd8);
+    packed = _mm256_max_epi8(packed, _mm256_setzero_si256());
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), packed);
+  }
+#elif defined(USE_SSE41)
+  for (size_t i = 0; i < N; i += 16) {
+    auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 8));
+    auto packed = _mm_max_epi8(_mm_packs_epi16(a, b), _mm_setzero_si128());
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+  }
+#else
+  for (size_t i = 0; i < N; ++i)
+    out[i] = uint8_t(std::clamp<int>(in[i], 0, 127));
+#endif
+}
+
+// Same for the int32 sums of hidden layers
+template <size_t N>
+void clippedRelu(const int32_t *in, uint8_t *out) {
+  for (size_t i = 0; i < N; ++i)
+    out[i] = uint8_t(std::clamp(in[i] >> weightShift, 0, 127));
+}
+
+// Dot product of N (a multiple of 32) unsigned inputs and signed weights
+template <size_t N>
+int32_t dot(const uint8_t *in, const int8_t *w) {
+#if defined(USE_AVX2)
+  const auto ones = _mm256_set1_epi16(1);
+  auto sum = _mm256_setzero_si256();
+  for (size_t i = 0; i < N; i += 32) {
+    auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + i));
+    // u8 * i8 pairs to i16 (can't saturate, inputs are at most 127),
+    // then i16 pairs to i32
+    auto products = _mm256_madd_epi16(_mm256_maddubs_epi16(a, b), ones);
+    sum = _mm256_add_epi32(sum, products);
+  }
+  auto half = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                            _mm256_extracti128_si256(sum, 1));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+  return _mm_cvtsi128_si32(half);
+#elif defined(USE_SSE41)
+  const auto ones = _mm_set1_epi16(1);
+  auto sum = _mm_setzero_si128();
+  for (size_t i = 0; i < N; i += 16) {
+    auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(a, b), ones));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+  return _mm_cvtsi128_si32(sum);
+#else
+  int32_t sum = 0;
+  for (size_t i = 0; i < N; ++i)
+    sum += int32_t(in[i]) * w[i];
+  return sum;
+#endif
+}
+
+// out[j] = bias[j] + in . weights[j]
+template <size_t In, size_t Out>
+void affine(const uint8_t *in, const int8_t *weights, const int32_t *bias,
+            int32_t *out) {
+  for (size_t j = 0; j < Out; ++j)
+    out[j] = bias[j] + dot<In>(in, weights + j * In);
+}
+} // anonymous namespace
+
+bool nnue::load(const std::string &path) {
+  unload();
+
+#if defined(NNUE_MMAP)
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  bool sized = fstat(fd, &st) == 0 && size_t(st.st_size) == fileSize;
+
+  void *mapping = sized ? mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0)
+                        : MAP_FAILED;
+  close(fd);
+
+  if (mapping == MAP_FAILED)
+    return false;
+
+  storage.data = static_cast<const char *>(mapping);
+  storage.mapped = true;
+#else
+  std::ifstream file(path, std::ios::binary);
+  storage.buffer.resize(fileSize + 1);
+  file.read(storage.buffer.data(), storage.buffer.size());
+  if (size_t(file.gcount()) != fileSize) {
+    storage.release();
+    return false;
+  }
+  storage.data = storage.buffer.data();
+#endif
+
+  Header expected, header;
+  std::memcpy(&header, storage.data, sizeof(Header));
+  if (std::memcmp(&header, &expected, sizeof(Header)) != 0) {
+    storage.release();
+    return false;
+  }
+
+  // Arrays follow each other in the order of the file layout
+  const char *p = storage.data + sizeof(Header);
+  auto take = [&p](auto *&array, const size_t count) {
+    array = reinterpret_cast<std::remove_reference_t<decltype(array)>>(p);
+    p += count * sizeof(*array);
+  };
+
+  take(network.ftBias, halfDims);
+  take(network.ftWeights, inputs * halfDims);
+  take(network.l1Bias, l1);
+  take(network.l1Weights, l1 * 2 * halfDims);
+  take(network.l2Bias, l2);
+  take(network.l2Weights, l2 * l1);
+  take(network.outBias, 1);
+  take(network.outWeights, l2);
+  assert(p == storage.data + fileSize);
+
+  return true;
+}
+
+void nnue::unload() { storage.release(); }
+
+bool nnue::loaded() { return storage.data != nullptr; }
+
+void AccumulatorStack::reset(const board::Board &b) {
+  assert(loaded());
+
+  top = 0;
+  refresh(b, stack[0], WHITE);
+  refresh(b, stack[0], BLACK);
+}
+
+void AccumulatorStack::push(const board::Board &b) {
+  assert(top + 1 < capacity);
+  current(b);
+  stack[top + 1] = stack[top];
+  ++top;
+}
+
+void AccumulatorStack::pop() {
+  assert(top > 0);
+  --top;
+}
+
+void AccumulatorStack::update(const board::Board &b, const unsigned char piece,
+                              const unsigned char sq, const bool add) {
+  Accumulator &acc = stack[top];
+
+  // Kings aren't features, but the king's move changes all features
+  // of its perspective
+  if (pieceK[piece]) {
+    acc.dirty[pieceCol[piece]] = true;
+    return;
+  }
+
+  for (Color perspective : {WHITE, BLACK}) {
+    if (acc.dirty[perspective])
+      continue;
+
+    size_t feature = featureIndex(perspective, b.getKing(perspective), piece, sq);
+    add ? updateFeature<true>(acc.values[perspective], feature)
+        : updateFeature<false>(acc.values[perspective], feature);
+  }
+}
+
+void AccumulatorStack::addPiece(const board::Board &b, const unsigned char piece,
+                                const unsigned char sq) {
+  update(b, piece, sq, true);
+}
+
+void AccumulatorStack::clearPiece(const board::Board &b,
+                                  const unsigned char piece,
+                                  const unsigned char sq) {
+  update(b, piece, sq, false);
+}
+
+void AccumulatorStack::movePiece(const board::Board &b,
+                                 const unsigned char piece,
+                                 const unsigned char from,
+                                 const unsigned char to) {
+  update(b, piece, from, false);
+  update(b, piece, to, true);
+}
+
+const Accumulator &AccumulatorStack::current(const board::Board &b) {
+  Accumulator &acc = stack[top];
+
+  for (Color perspective : {WHITE, BLACK})
+    if (acc.dirty[perspective])
+      refresh(b, acc, perspective);
+
+  return acc;
+}
+
+int nnue::evaluate(const board::Board &b, AccumulatorStack &accumulators) {
+  assert(loaded());
+
+  const Accumulator &acc = accumulators.current(b);
+  const Color us = b.getSide(), them = Color(us ^ 1);
+
+  alignas(32) std::array<uint8_t, 2 * halfDims> input;
+  clippedRelu<halfDims>(acc.values[us].data(), input.data());
+  clippedRelu<halfDims>(acc.values[them].data(), input.data() + halfDims);
+
+  alignas(32) std::array<int32_t, l1> sums1;
+  alignas(32) std::array<uint8_t, l1> hidden1;
+  affine<2 * halfDims, l1>(input.data(), network.l1Weights, network.l1Bias,
+                           sums1.data());
+  clippedRelu<l1>(sums1.data(), hidden1.data());
+
+  alignas(32) std::array<int32_t, l2> sums2;
+  alignas(32) std::array<uint8_t, l2> hidden2;
+  affine<l1, l2>(hidden1.data(), network.l2Weights, network.l2Bias,
+                 sums2.data());
+  clippedRelu<l2>(sums2.data(), hidden2.data());
+
+  // Saturated layers give up to ~32k, static scores must stay below
+  // mate scores or the search would take them for mates
+  constexpr int maxScore = search::mate - search::maxPly - 1;
+  const int score =
+      (*network.outBias + dot<l2>(hidden2.data(), network.outWeights)) /
+      outputScale;
+
+  return std::clamp(score, -maxScore, maxScore);
+}
@@ -0,0 +1,81 @@
+// Licensed after GNU GPL v3
+
+#include <algorithm>
+#include <bit>
+
+#include "attacks.hpp"
+#include "pawns.hpp"
+
+using namespace search;
+
+namespace {
+// Adds pawns of `Us` to the counters
+template <Color Us>
+void countPawns(const board::Board &b, PawnTerms &terms) {
+  constexpr int sign = Us == WHITE ? 1 : -1;
+
+  const size_t own   = b.getPieceBB(Us == WHITE ? wP : bP),
+               enemy = b.getPieceBB(Us == WHITE ? bP : wP);
+
+  for (size_t bb = own; bb;) {
+    const unsigned char sq = popBit(bb);
+    const int rank = Us == WHITE ? sq / 8 : 7 - sq / 8;
+
+    if (pawnMask.front[Us][sq] & own)
+      terms.doubled += sign;
+
+    // Backward pawn can't be defended by pawns, and can't advance
+    // without being taken by an enemy pawn
+    if (!(pawnMask.adjacent[sq] & own))
+      terms.isolated += sign;
+    else if (!(pawnMask.support[Us][sq] & own) &&
+             (pawnAttacks[Us][sq + (Us == WHITE ? 8 : -8)] & enemy))
+      terms.backward += sign;
+
+    if (!(pawnMask.passed[Us][sq] & enemy))
+      terms.passed[rank] += sign;
+  }
+}
+} // anonymous namespace
+
+PawnTerms search::countPawnTerms(const board::Board &b) {
+  PawnTerms terms;
+
+  countPawns<WHITE>(b, terms);
+  countPawns<BLACK>(b, terms);
+
+  return terms;
+}
+
+PawnEntry search::evaluatePawns(const board::Board &b) {
+  PawnEntry entry{b.getPawnKey(), {0, 0}};
+  const PawnTerms terms = countPawnTerms(b);
+
+  for (GamePhase phase : {MG, EG}) {
+    int &score = entry.score[phase];
+
+    score += terms.doubled  * doubledPawn[phase] +
+             terms.isolated * isolatedPawn[phase] +
+             terms.backward * backwardPawn[phase];
+
+    for (size_t rank = 0; rank < terms.passed.size(); ++rank)
+      score += terms.passed[rank] * passedPawn[phase][rank];
+  }
+
+  return entry;
+}
+
+PawnTable::PawnTable(const size_t size)
+    : entries(std::bit_floor(std::max<size_t>(size, 1)), PawnEntry{0, {0, 0}}) {}
+
+const std::array<int, 2> &PawnTable::probe(const board::Board &b) {
+  PawnEntry &entry = entries[b.getPawnKey() & (entries.size() - 1)];
+
+  ++probes;
+  if (entry.key == b.getPawnKey())
+    ++hits;
+  else
+    entry = evaluatePawns(b);
+
+  return entry.score;
+}
@@ -0,0 +1,307 @@
+// Licensed after GNU GPL v3
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "perft.hpp"
+
+namespace {
+// Moves from the root to the node which is counted by one task
+struct Task {
+  std::array<move::Move, perft::maxSplitDepth> path;
+  unsigned char length;
+  unsigned char root; // index of the root move
+};
+
+// Collects all nodes `splitDepth` plies below the current one
+void splitTree(board::Board &b, Task &task, const unsigned char splitDepth,
+               std::vector<Task> &tasks) {
+  if (task.length == splitDepth) {
+    tasks.push_back(task);
+    return;
+  }
+
+  move::MoveList l;
+  l.generateLegalMoves(b);
+
+  for (size_t i = 0; i < l.size(); ++i) {
+    if (task.length == 0)
+      task.root = i;
+
+    task.path[task.length++] = l[i];
+    b.makeLegalMove(l[i]);
+    splitTree(b, task, splitDepth, tasks);
+    b.takeBackMove();
+    --task.length;
+  }
+}
+
+// Tasks of one worker: the owner takes them from the back,
+// other workers steal them from the front
+class TaskQueue {
+  std::deque<size_t> tasks;
+  std::mutex mutex;
+
+public:
+  void push(const size_t task) {
+    std::lock_guard lock(mutex);
+    tasks.push_back(task);
+  }
+
+  bool pop(size_t &task) {
+    std::lock_guard lock(mutex);
+    if (tasks.empty())
+      return false;
+    task = tasks.back();
+    tasks.pop_back();
+    return true;
+  }
+
+  bool steal(size_t &task) {
+    std::lock_guard lock(mutex);
+    if (tasks.empty())
+      return false;
+    task = tasks.front();
+    tasks.pop_front();
+    return true;
+  }
+};
+} // anonymous namespace
+
+size_t perft::perft(board::Board &b, const unsigned char depth) {
+  b.check();
+
+  if (depth == 0)
+    return 1;
+
+  // Bulk counting at the frontier, leaves are never made
+  if (depth == 1)
+    return move::countLegalMoves(b);
+
+  move::MoveList l;
+  l.generateLegalMoves(b);
+
+  size_t nodes = 0;
+
+  for (auto m : l) {
+    b.makeLegalMove(m);
+    nodes += perft(b, depth - 1);
+    b.takeBackMove();
+  }
+
+  return nodes;
+}
+
+std::vector<perft::DivideEntry> perft::divide(board::Board &b,
+                                              const unsigned char depth) {
+  std::vector<DivideEntry> result;
+
+  if (depth == 0)
+    return result;
+
+  move::MoveList l;
+  l.generateLegalMoves(b);
+
+  for (auto m : l) {
+    b.makeLegalMove(m);
+    result.push_back({m, perft(b, depth - 1)});
+    b.takeBackMove();
+  }
+
+  return result;
+}
+
+std::vector<perft::DivideEntry> perft::parallelDivide(
+    const board::Board &b, const unsigned char depth, unsigned threads,
+    unsigned char splitDepth) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  board::Board root = b;
+
+  if (depth <= 1 || threads == 1)
+    return divide(root, depth);
+
+  // Every task must have at least one ply to count
+  splitDepth = std::clamp<unsigned char>(
+      splitDepth, 1, std::min<unsigned char>(maxSplitDepth, depth - 1));
+
+  std::vector<DivideEntry> result;
+
+  move::MoveList l;
+  l.generateLegalMoves(root);
+  for (auto m : l)
+    result.push_back({m, 0});
+
+  std::vector<Task> tasks;
+  Task task{};
+  splitTree(root, task, splitDepth, tasks);
+
+  std::vector<TaskQueue> queues(threads);
+  for (size_t i = 0; i < tasks.size(); ++i)
+    queues[i % threads].push(i);
+
+  // Leaf nodes of each root move counted by each worker
+  std::vector<std::vector<size_t>> nodes(threads,
+                                         std::vector<size_t>(l.size()));
+
+  auto worker = [&](const unsigned id) {
+    board::Board local = b;
+
+    auto next = [&](size_t &t) {
+      if (queues[id].pop(t))
+        return true;
+      for (unsigned i = 1; i < threads; ++i)
+        if (queues[(id + i) % threads].steal(t))
+          return true;
+      return false;
+    };
+
+    for (size_t t; next(t);) {
+      const Task &task = tasks[t];
+
+      for (unsigned char i = 0; i < task.length; ++i)
+        local.makeLegalMove(task.path[i]);
+
+      nodes[id][task.root] += perft(local, depth - task.length);
+
+      for (unsigned char i = 0; i < task.length; ++i)
+        local.takeBackMove();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned id = 0; id < threads; ++id)
+    workers.emplace_back(worker, id);
+  for (auto &w : workers)
+    w.join();
+
+  for (auto &&counts : nodes)
+    for (size_t i = 0; i < counts.size(); ++i)
+      result[i].nodes += counts[i];
+
+  return result;
+}
+
+size_t perft::parallelPerft(const board::Board &b, const unsigned char depth,
+                            unsigned threads, unsigned char splitDepth) {
+  if (depth == 0)
+    return 1;
+
+  size_t nodes = 0;
+  for (auto &&entry : parallelDivide(b, depth, threads, splitDepth))
+    nodes += entry.nodes;
+
+  return nodes;
+}
+
+perft::PerftTable::PerftTable(const size_t mb, const bool verify_)
+    : verify(verify_), collisions(0) {
+  size_t count = std::max<size_t>(1, (mb << 20) / sizeof(Entry));
+  entries.resize(std::bit_floor(count));
+  clear();
+}
+
+bool perft::PerftTable::probe(const size_t key, const unsigned char depth,
+                              size_t &nodes) const {
+  const Entry &e = entries[key & (entries.size() - 1)];
+
+  if (e.key != key || e.depth != depth)
+    return false;
+
+  nodes = e.nodes;
+  return true;
+}
+
+void perft::PerftTable::store(const size_t key, const unsigned char depth,
+                              const size_t nodes) {
+  Entry &e = entries[key & (entries.size() - 1)];
+
+  if (depth >= e.depth)
+    e = {key, nodes, depth};
+}
+
+void perft::PerftTable::clear() {
+  std::fill(entries.begin(), entries.end(), Entry{0, 0, 0});
+  collisions = 0;
+}
+
+size_t perft::hashPerft(board::Board &b, const unsigned char depth,
+                        PerftTable &table) {
+  // Shallow subtrees are cheaper to count than to cache
+  if (depth <= 1)
+    return perft(b, depth);
+
+  size_t nodes = 0;
+
+  if (table.probe(b.getPosKey(), depth, nodes)) {
+    if (table.verifying()) {
+      size_t uncached = perft(b, depth);
+      if (uncached != nodes) {
+        table.addCollision();
+        nodes = uncached;
+      }
+    }
+    return nodes;
+  }
+
+  move::MoveList l;
+  l.generateLegalMoves(b);
+
+  for (auto m : l) {
+    b.makeLegalMove(m);
+    nodes += hashPerft(b, depth - 1, table);
+    b.takeBackMove();
+  }
+
+  table.store(b.getPosKey(), depth, nodes);
+
+  return nodes;
+}
+
+perft::TestCase perft::parseTestCase(const std::string_view &line) {
+  TestCase test;
+
+  auto fend = line.find(';');
+  std::string_view fen = line.substr(0, fend);
+
+  while (!fen.empty() && fen.back() == ' ')
+    fen.remove_suffix(1);
+  test.fen = fen;
+
+  // Every field looks like "D<depth> <nodes> "
+  while (fend != std::string_view::npos) {
+    auto next = line.find(';', fend + 1);
+    std::string_view field = line.substr(fend + 1, next - fend - 1);
+
+    auto space = field.find(' ');
+    if (space != std::string_view::npos) {
+      size_t nodes = 0;
+      std::from_chars(field.data() + space + 1, field.data() + field.size(),
+                      nodes);
+      test.nodes.push_back(nodes);
+    }
+
+    fend = next;
+  }
+
+  return test;
+}
+
+std::optional<std::vector<perft::TestCase>>
+perft::loadSuite(std::istream &is) {
+  std::vector<TestCase> suite;
+
+  for (std::string line; std::getline(is, line);)
+    if (line.find(';') != std::string::npos) {
+      suite.push_back(parseTestCase(line));
+      if (!board::validFEN(suite.back().fen))
+        return std::nullopt;
+    }
+
+  return suite;
+}
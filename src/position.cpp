@@ -0,0 +1,177 @@
+// Licensed after GNU GPL v3
+
+#include <cassert>
+
+#include "attacks.hpp"
+#include "board.hpp"
+#include "position.hpp"
+#include "valid.hpp"
+
+using namespace board;
+
+Position::Position(const Board &b)
+    : pieceBB{}, colorBB{}, posKey(b.getPosKey()), side(b.getSide()),
+      enPas(b.getEnPas()), fiftyMove(b.getFiftyMove()),
+      castlePerm(b.getCastlePerm()) {
+  for (int sq = 0; sq < largeNC; ++sq)
+    board[sq] = b.getPiece(sq);
+
+  for (int piece = wP; piece <= bK; ++piece)
+    pieceBB[piece] = b.getPieceBB(piece);
+
+  for (int col = WHITE; col <= BOTH; ++col)
+    colorBB[col] = b.getColorBB(Color(col));
+}
+
+Position::Position(const std::string_view &fen) : Position(Board(fen)) {}
+
+size_t Position::generate() const {
+  size_t key = 0;
+
+  for (int sq = 0; sq < largeNC; ++sq) {
+    unsigned char piece = board[sq];
+    if (piece != EMPTY && piece != OFFBOARD)
+      key ^= pieceKeys[piece][sq];
+  }
+
+  if (side == WHITE)
+    key ^= sideKey;
+
+  if (enPas != NO_SQ)
+    key ^= pieceKeys[EMPTY][enPas];
+
+  key ^= castleKeys[castlePerm];
+
+  return key;
+}
+
+void Position::check() const {
+#if defined(DEBUG_ONLY)
+  size_t t_colorBB[3] = {0ull, 0ull, 0ull};
+
+  for (unsigned char sq64 = 0; sq64 < regularNC; ++sq64) {
+    unsigned char piece = board[convert64To120(sq64)];
+
+    if (piece != EMPTY) {
+      assert(pieceBB[piece] & setMask[sq64]);
+      t_colorBB[pieceCol[piece]] |= setMask[sq64];
+    }
+  }
+
+  assert(t_colorBB[WHITE] == colorBB[WHITE] &&
+         t_colorBB[BLACK] == colorBB[BLACK]);
+  assert((colorBB[WHITE] | colorBB[BLACK]) == colorBB[BOTH]);
+
+  assert(std::has_single_bit(pieceBB[wK]) && std::has_single_bit(pieceBB[bK]));
+  assert(side == WHITE || side == BLACK);
+  assert(generate() == posKey);
+#endif
+}
+
+bool Position::isAttacked(const unsigned char sq, const Color side_) const {
+  return isSquareAttacked(pieceBB, colorBB[BOTH], convert120To64(sq), side_);
+}
+
+void Position::clearPiece(const unsigned char sq) {
+  unsigned char piece = board[sq];
+  assert(isPieceValid(piece));
+
+  posKey ^= pieceKeys[piece][sq];
+  board[sq] = EMPTY;
+
+  clearBit(pieceBB[piece],           convert120To64(sq));
+  clearBit(colorBB[pieceCol[piece]], convert120To64(sq));
+  clearBit(colorBB[BOTH],            convert120To64(sq));
+}
+
+void Position::addPiece(const unsigned char sq, const unsigned char piece) {
+  assert(isPieceValid(piece));
+
+  posKey ^= pieceKeys[piece][sq];
+  board[sq] = piece;
+
+  setBit(pieceBB[piece],           convert120To64(sq));
+  setBit(colorBB[pieceCol[piece]], convert120To64(sq));
+  setBit(colorBB[BOTH],            convert120To64(sq));
+}
+
+void Position::movePiece(const unsigned char from, const unsigned char to) {
+  unsigned char piece = board[from];
+  assert(isPieceValid(piece));
+
+  posKey ^= pieceKeys[piece][from] ^ pieceKeys[piece][to];
+  board[from] = EMPTY;
+  board[to] = piece;
+
+  size_t fromTo = setMask[convert120To64(from)] | setMask[convert120To64(to)];
+  pieceBB[piece]           ^= fromTo;
+  colorBB[pieceCol[piece]] ^= fromTo;
+  colorBB[BOTH]            ^= fromTo;
+}
+
+template <Color Us>
+void Position::doMove(const move::Move &move) {
+  unsigned char from     = move.getFrom(),
+                to       = move.getTo(),
+                captured = move.getCaptured(),
+                promoted = move.getPromoted();
+
+  assert(isOnBoard(from));
+  assert(isOnBoard(to));
+  assert(side == Us);
+
+  if (move.getCastle()) {
+    assert(to == (Us == WHITE ? C1 : C8) || to == (Us == WHITE ? G1 : G8));
+    if (to == (Us == WHITE ? C1 : C8))
+      movePiece(Us == WHITE ? A1 : A8, Us == WHITE ? D1 : D8);
+    else
+      movePiece(Us == WHITE ? H1 : H8, Us == WHITE ? F1 : F8);
+  }
+  else if (move.getEnPas())
+    clearPiece(to + (Us == WHITE ? -10 : 10));
+
+  if (enPas != NO_SQ)
+    posKey ^= pieceKeys[EMPTY][enPas];
+  posKey ^= castleKeys[castlePerm];
+
+  castlePerm &= bCastlePerm[to];
+  castlePerm &= bCastlePerm[from];
+  enPas = NO_SQ;
+
+  posKey ^= castleKeys[castlePerm];
+
+  ++fiftyMove;
+  if (captured != EMPTY) {
+    clearPiece(to);
+    fiftyMove = 0;
+  }
+
+  if (pieceP[board[from]]) {
+    fiftyMove = 0;
+    if (move.getPawnStart()) {
+      enPas = Cell(from + (Us == WHITE ? 10 : -10));
+      posKey ^= pieceKeys[EMPTY][enPas];
+    }
+  }
+
+  movePiece(from, to);
+
+  if (promoted != EMPTY) {
+    clearPiece(to);
+    addPiece(to, promoted);
+  }
+
+  side = Color(Us ^ 1);
+  posKey ^= sideKey;
+}
+
+bool Position::makeMove(const move::Move &move, Position &child) const {
+  check();
+
+  child = *this;
+  side == WHITE ? child.doMove<WHITE>(move) : child.doMove<BLACK>(move);
+
+  child.check();
+
+  return !child.isAttacked(child.getKing(side), child.side);
+}
@@ -0,0 +1,479 @@
+// Licensed after GNU GPL v3
+
+#include <algorithm>
+#include <thread>
+
+#include "attacks.hpp"
+#include "search.hpp"
+
+using namespace search;
+
+namespace {
+// Mate scores are stored as distance from the node, not from the root
+int scoreToTT(const int score, const size_t ply) {
+  return score >= mate - maxPly ? score + int(ply)
+       : score <= -mate + maxPly ? score - int(ply)
+       : score;
+}
+
+int scoreFromTT(const int score, const size_t ply) {
+  return score >= mate - maxPly ? score - int(ply)
+       : score <= -mate + maxPly ? score + int(ply)
+       : score;
+}
+
+// Base scores of move ordering classes, every class
+// stays below the next one
+constexpr unsigned ttMoveScore   = 1u << 30,
+                   tacticalScore = 1u << 28,
+                   killerScore   = 1u << 27,
+                   counterScore  = 1u << 26,
+                   historyMax    = 1u << 25;
+
+int blend(const board::Board &b, const std::array<int, 2> &pawns) {
+  // Material includes king values, they cancel out in the difference
+  int score = int(b.getMaterial(WHITE) - b.getMaterial(BLACK));
+
+  // Positional terms are blended: the middlegame ones
+  // fade out as pieces leave the board
+  const int phase = b.getPhase();
+  const int mg = b.getPsq(MG) + pawns[MG], eg = b.getPsq(EG) + pawns[EG];
+  score += (mg * phase + eg * (maxPhase - phase)) / maxPhase;
+
+  return b.getSide() == WHITE ? score : -score;
+}
+
+bool sameMove(const move::Move &lhs, const move::Move &rhs) {
+  return lhs.getInfo() == rhs.getInfo();
+}
+
+// Capture of a piece at least as valuable as the attacker can't lose
+// material, so the exchange is evaluated only for the others
+bool losesMaterial(const board::Board &b, const move::Move &m) {
+  return pieceVal[b.getPiece(m.getFrom())] > pieceVal[m.getCaptured()] &&
+         see(b, m) < 0;
+}
+} // anonymous namespace
+
+int search::evaluate(const board::Board &b) {
+  return blend(b, evaluatePawns(b).score);
+}
+
+int search::evaluate(const board::Board &b, PawnTable &pawns) {
+  if (b.getAccumulators())
+    return nnue::evaluate(b, *b.getAccumulators());
+
+  return blend(b, pawns.probe(b));
+}
+
+int search::see(const board::Board &b, const move::Move &m) {
+  if (m.getCastle())
+    return 0;
+
+  const unsigned char to = m.getTo(), to64 = convert120To64(to);
+  const size_t bishops = b.getPieceBB(wB) | b.getPieceBB(bB) |
+                         b.getPieceBB(wQ) | b.getPieceBB(bQ),
+               rooks   = b.getPieceBB(wR) | b.getPieceBB(bR) |
+                         b.getPieceBB(wQ) | b.getPieceBB(bQ);
+
+  size_t occupied = b.getColorBB(BOTH) ^ setMask[convert120To64(m.getFrom())];
+  unsigned char onSquare = m.getPromoted() != EMPTY ? m.getPromoted()
+                                                    : b.getPiece(m.getFrom());
+
+  // gain[d] - material won by the side making d-th capture,
+  // if the exchange stops after it
+  std::array<int, 32> gain;
+  gain[0] = m.getPromoted() != EMPTY
+                ? pieceVal[m.getPromoted()] - pieceVal[wP]
+                : 0;
+
+  if (m.getEnPas()) {
+    gain[0] += pieceVal[wP];
+    occupied ^= setMask[to64 + (b.getSide() == WHITE ? -8 : 8)];
+  }
+  else
+    gain[0] += pieceVal[m.getCaptured()];
+
+  size_t attackers = b.attackersTo(to, occupied);
+  Color side = Color(b.getSide() ^ 1);
+  size_t d = 0;
+
+  while (d + 1 < gain.size()) {
+    const size_t own = attackers & b.getColorBB(side);
+    if (!own)
+      break;
+
+    // Least valuable attacker
+    unsigned char piece = side == WHITE ? wP : bP;
+    while (!(own & b.getPieceBB(piece)))
+      ++piece;
+
+    // King can't capture a defended piece
+    if ((piece == wK || piece == bK) &&
+        (attackers & b.getColorBB(Color(side ^ 1))))
+      break;
+
+    ++d;
+    gain[d] = pieceVal[onSquare] - gain[d - 1];
+
+    const size_t from = own & b.getPieceBB(piece);
+    occupied ^= from & -from;
+
+    // Sliders behind the piece which has just captured
+    attackers = (attackers | (bishopAttacks(to64, occupied) & bishops) |
+                 (rookAttacks(to64, occupied) & rooks)) & occupied;
+
+    onSquare = piece;
+    side = Color(side ^ 1);
+  }
+
+  // Every side stops the exchange when capturing further loses
+  for (; d > 0; --d)
+    gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+
+  return gain[0];
+}
+
+void Searcher::scoreMoves(move::MoveList &l, const move::Move &ttMove) const {
+  const size_t ply = b.getPly();
+  const move::Move prev = b.getLastMove();
+  const move::Move counter =
+      prev.getInfo() ? counterMoves[b.getPiece(prev.getTo())][prev.getTo()]
+                     : move::Move();
+
+  for (size_t i = 0; i < l.size(); ++i) {
+    move::Move &m = l[i];
+
+    // Captures and promotions are scored by the generator,
+    // the losing ones go after killers and the counter move
+    if (sameMove(m, ttMove))
+      m.SetScore(ttMoveScore);
+    else if (m.isTactical())
+      m.SetScore(losesMaterial(b, m) ? m.getScore()
+                                     : tacticalScore + m.getScore());
+    else if (sameMove(m, killers[ply][0]))
+      m.SetScore(killerScore + 1);
+    else if (sameMove(m, killers[ply][1]))
+      m.SetScore(killerScore);
+    else if (sameMove(m, counter))
+      m.SetScore(counterScore);
+    else
+      m.SetScore(history[b.getSide()][convert120To64(m.getFrom())]
+                        [convert120To64(m.getTo())]);
+  }
+}
+
+void Searcher::updateQuietStats(const move::Move &m, const int depth) {
+  const size_t ply = b.getPly();
+
+  if (!sameMove(m, killers[ply][0])) {
+    killers[ply][1] = killers[ply][0];
+    killers[ply][0] = m;
+  }
+
+  const move::Move prev = b.getLastMove();
+  if (prev.getInfo())
+    counterMoves[b.getPiece(prev.getTo())][prev.getTo()] = m;
+
+  unsigned &h = history[b.getSide()][convert120To64(m.getFrom())]
+                       [convert120To64(m.getTo())];
+  h += depth * depth;
+
+  // Old statistics become less important
+  if (h >= historyMax)
+    for (auto &&side : history)
+      for (auto &&from : side)
+        for (auto &&entry : from)
+          entry /= 2;
+}
+
+void Searcher::countNode() {
+  ++nodes;
+  if ((limits.nodes && nodes >= limits.nodes) ||
+      (stop && stop->load(std::memory_order_relaxed)))
+    stopped = true;
+}
+
+int Searcher::quiescence(int alpha, int beta) {
+  const size_t ply = b.getPly();
+  pvLength[ply] = ply;
+
+  countNode();
+  if (stopped)
+    return 0;
+
+  if (ply >= maxPly - 1 || b.history_full())
+    return evaluate(b, pawnTable);
+
+  // In check every evasion is searched, standing pat isn't allowed
+  const bool inCheck = b.inCheck();
+  const int standPat = inCheck ? -infinite : evaluate(b, pawnTable);
+
+  if (!inCheck) {
+    if (standPat >= beta)
+      return standPat;
+
+    // Even the capture of a queen with promotion can't raise alpha
+    if (standPat + pieceVal[wQ] * 2 - pieceVal[wP] < alpha)
+      return standPat;
+
+    alpha = std::max(alpha, standPat);
+  }
+
+  move::MoveList l;
+  inCheck ? l.generateEvasions(b) : l.generateCaptures(b);
+
+  int best = standPat;
+  bool legal = false;
+
+  // Captures are scored by MVV-LVA at generation
+  for (size_t i = 0; i < l.size(); ++i) {
+    move::Move m = l.pickBest(i);
+
+    // Delta pruning: the captured piece with a margin doesn't reach alpha
+    const unsigned char victim =
+        m.getEnPas() ? (unsigned char)wP : m.getCaptured();
+    if (!inCheck && m.getPromoted() == EMPTY &&
+        standPat + pieceVal[victim] + deltaMargin <= alpha)
+      continue;
+
+    // Losing captures are not going to raise alpha either
+    if (!inCheck && losesMaterial(b, m))
+      continue;
+
+    if (!b.makeMove(m))
+      continue;
+
+    legal = true;
+    int score = -quiescence(-beta, -alpha);
+
+    b.takeBackMove();
+
+    if (stopped)
+      return 0;
+
+    if (score > best) {
+      best = score;
+      if (score > alpha) {
+        alpha = score;
+        if (alpha >= beta)
+          break;
+      }
+    }
+  }
+
+  if (inCheck && !legal)
+    return -mate + int(ply);
+
+  return best;
+}
+
+int Searcher::negamax(int alpha, int beta, int depth) {
+  if (depth <= 0)
+    return quiescence(alpha, beta);
+
+  const size_t ply = b.getPly();
+  pvLength[ply] = ply;
+
+  // The node which reaches the limit is not searched, otherwise every
+  // node on the way down would be counted over the limit
+  countNode();
+  if (stopped)
+    return 0;
+
+  if (ply && (b.getFiftyMove() >= 100 || b.isRepetition()))
+    return 0;
+
+  // No move can be made once the history is full
+  if (ply >= maxPly - 1 || b.history_full())
+    return evaluate(b, pawnTable);
+
+  const int alphaOrig = alpha;
+  const bool pvNode = beta - alpha > 1;
+
+  move::Move ttMove = ply == 0 ? rootBest : move::Move();
+
+  TTEntry entry;
+  if (tt && tt->probe(b.getPosKey(), entry)) {
+    if (entry.move.getInfo() != 0)
+      ttMove = entry.move;
+
+    if (!pvNode && entry.depth >= depth) {
+      int score = scoreFromTT(entry.score, ply);
+      if (entry.bound == EXACT ||
+          (entry.bound == LOWER && score >= beta) ||
+          (entry.bound == UPPER && score <= alpha))
+        return score;
+    }
+  }
+
+  move::MoveList l;
+  l.generateLegalMoves(b);
+
+  if (l.size() == 0)
+    return b.inCheck() ? -mate + int(ply) : 0;
+
+  // The best move from the table or the previous iteration goes first
+  scoreMoves(l, ttMove);
+
+  int best = -infinite;
+  move::Move bestMove;
+
+  for (size_t i = 0; i < l.size(); ++i) {
+    move::Move m = l.pickBest(i);
+    int score;
+
+    b.makeLegalMove(m);
+
+    // The first move is expected to be the best one, the others
+    // are searched with null window and only re-searched if they beat it
+    if (i == 0)
+      score = -negamax(-beta, -alpha, depth - 1);
+    else {
+      score = -negamax(-alpha - 1, -alpha, depth - 1);
+      if (!stopped && score > alpha && score < beta)
+        score = -negamax(-beta, -alpha, depth - 1);
+    }
+
+    b.takeBackMove();
+
+    if (stopped)
+      return 0;
+
+    if (score > best) {
+      best = score;
+      bestMove = m;
+
+      if (score > alpha) {
+        alpha = score;
+
+        pvTable[ply][ply] = m;
+        for (size_t next = ply + 1; next < pvLength[ply + 1]; ++next)
+          pvTable[ply][next] = pvTable[ply + 1][next];
+        pvLength[ply] = pvLength[ply + 1];
+
+        if (alpha >= beta) {
+          if (!m.isTactical())
+            updateQuietStats(m, depth);
+          break;
+        }
+      }
+    }
+  }
+
+  if (tt)
+    tt->store(b.getPosKey(), bestMove, scoreToTT(best, ply), depth,
+              best >= beta ? LOWER : best > alphaOrig ? EXACT : UPPER);
+
+  return best;
+}
+
+Result Searcher::search() {
+  Result result;
+
+  b.resetPly();
+  nodes = 0;
+  stopped = false;
+  rootBest = move::Move();
+
+  for (auto &&k : killers)
+    k.fill(move::Move());
+  for (auto &&side : history)
+    for (auto &&from : side)
+      from.fill(0);
+  for (auto &&piece : counterMoves)
+    piece.fill(move::Move());
+
+  // Accumulators the caller has attached follow the search as well,
+  // every move is taken back, so they end up where they were
+  const bool attach = nnue::loaded() && !b.getAccumulators();
+  if (attach) {
+    if (!accumulators)
+      accumulators = std::make_unique<nnue::AccumulatorStack>();
+    b.attach(accumulators.get());
+  }
+
+  for (int depth = 1 + depthOffset;
+       depth <= std::min<int>(limits.depth, maxPly - 1); ++depth) {
+    pvLength.fill(0);
+    int score = negamax(-infinite, infinite, depth);
+
+    // The iteration which was not completed is thrown away,
+    // unless there are no results at all
+    if (stopped && result.depth != 0)
+      break;
+
+    if (pvLength[0] != 0) {
+      result.pv.assign(pvTable[0].begin(), pvTable[0].begin() + pvLength[0]);
+      result.bestMove = rootBest = result.pv[0];
+    }
+
+    result.score = score;
+
+    if (stopped)
+      break;
+
+    result.depth = depth;
+
+    // Nothing to search deeper
+    if (isMate(score))
+      break;
+  }
+
+  // Stopped before the first root move was searched
+  if (result.pv.empty()) {
+    move::MoveList l;
+    l.generateLegalMoves(b);
+    if (l.size() != 0)
+      result.bestMove = l[0];
+  }
+
+  result.nodes = nodes;
+
+  if (attach)
+    b.attach(nullptr);
+
+  return result;
+}
+
+int Searcher::qsearch() {
+  b.resetPly();
+  nodes = 0;
+  stopped = false;
+
+  return quiescence(-infinite, infinite);
+}
+
+Result search::parallelSearch(const board::Board &b, const Limits &limits,
+                              TranspositionTable &tt, unsigned threads) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  tt.newSearch();
+
+  std::atomic<bool> stop = false;
+  std::atomic<size_t> helperNodes = 0;
+
+  // Every thread owns its board, and accumulators
+  // as copies would share the ones of `b`
+  std::vector<board::Board> boards(threads, b);
+  for (auto &&copy : boards)
+    copy.attach(nullptr);
+
+  std::vector<std::thread> helpers;
+  for (unsigned id = 1; id < threads; ++id)
+    helpers.emplace_back([&, id] {
+      Result r = Searcher(boards[id], Limits{}, &tt, &stop, id % 2).search();
+      helperNodes += r.nodes;
+    });
+
+  Result result = Searcher(boards[0], limits, &tt, &stop).search();
+
+  stop = true;
+  for (auto &helper : helpers)
+    helper.join();
+
+  result.nodes += helperNodes;
+
+  return result;
+}
@@ -0,0 +1,104 @@
+// Licensed after GNU GPL v3
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstdint>
+
+#include "tt.hpp"
+
+using namespace search;
+
+namespace {
+constexpr unsigned moveBits = 25, scoreBits = 16, depthBits = 8, boundBits = 2;
+
+constexpr unsigned scoreShift = moveBits,
+                   depthShift = scoreShift + scoreBits,
+                   boundShift = depthShift + depthBits,
+                   ageShift   = boundShift + boundBits;
+
+constexpr size_t field(const size_t data, const unsigned shift,
+                       const unsigned bits) {
+  return (data >> shift) & ((1ull << bits) - 1);
+}
+
+unsigned char depthOf(const size_t data) {
+  return field(data, depthShift, depthBits);
+}
+unsigned char ageOf(const size_t data) { return field(data, ageShift, 6); }
+} // anonymous namespace
+
+size_t TranspositionTable::pack(const move::Move &move, const int score,
+                                const unsigned char depth, const Bound bound,
+                                const unsigned char age) {
+  return size_t(move.getInfo())                         |
+         size_t(uint16_t(int16_t(score))) << scoreShift |
+         size_t(depth)                    << depthShift |
+         size_t(bound)                    << boundShift |
+         size_t(age)                      << ageShift;
+}
+
+void TranspositionTable::resize(const size_t mb) {
+  count = std::bit_floor(std::max<size_t>(1, (mb << 20) / sizeof(Bucket)));
+  buckets = std::make_unique<Bucket[]>(count);
+  clear();
+}
+
+void TranspositionTable::clear() {
+  for (size_t i = 0; i < count; ++i)
+    for (auto &slot : buckets[i].slots) {
+      slot.check.store(0, std::memory_order_relaxed);
+      slot.data.store(0, std::memory_order_relaxed);
+    }
+  age = 0;
+}
+
+bool TranspositionTable::probe(const size_t key, TTEntry &entry) const {
+  for (auto &slot : bucket(key).slots) {
+    size_t data  = slot.data.load(std::memory_order_relaxed),
+           check = slot.check.load(std::memory_order_relaxed);
+
+    if ((check ^ data) != key || data == 0)
+      continue;
+
+    entry.move  = move::Move(int(field(data, 0, moveBits)));
+    entry.score = int16_t(field(data, scoreShift, scoreBits));
+    entry.depth = depthOf(data);
+    entry.bound = Bound(field(data, boundShift, boundBits));
+    return true;
+  }
+
+  return false;
+}
+
+void TranspositionTable::store(const size_t key, const move::Move &move,
+                               const int score, const unsigned char depth,
+                               const Bound bound) {
+  Slot *replace = nullptr;
+  move::Move best = move;
+  int worst = INT_MAX;
+
+  for (auto &slot : bucket(key).slots) {
+    size_t data  = slot.data.load(std::memory_order_relaxed),
+           check = slot.check.load(std::memory_order_relaxed);
+
+    // The same position keeps its move if the new one has no move
+    if (data == 0 || (check ^ data) == key) {
+      if (data != 0 && best.getInfo() == 0)
+        best = move::Move(int(field(data, 0, moveBits)));
+      replace = &slot;
+      break;
+    }
+
+    // Shallow and old entries go first
+    int value = depthOf(data) - 8 * ((age - ageOf(data)) & 63);
+    if (value < worst) {
+      worst = value;
+      replace = &slot;
+    }
+  }
+
+  size_t data = pack(best, score, depth, bound, age);
+  replace->check.store(key ^ data, std::memory_order_relaxed);
+  replace->data.store(data, std::memory_order_relaxed);
+}
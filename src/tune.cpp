@@ -0,0 +1,173 @@
+// Licensed after GNU GPL v3
+
+#include <charconv>
+#include <cmath>
+#include <iomanip>
+
+#include "pawns.hpp"
+#include "tune.hpp"
+
+using namespace tune;
+
+namespace {
+size_t pstIndex(const GamePhase phase, const size_t type, const size_t sq) {
+  return pstOffset + (phase * 6 + type) * regularNC + sq;
+}
+
+size_t passedIndex(const GamePhase phase, const size_t rank) {
+  return passedOffset + phase * 8 + rank;
+}
+
+std::string_view trim(std::string_view s, const std::string_view chars) {
+  const size_t first = s.find_first_not_of(chars);
+  if (first == std::string_view::npos)
+    return {};
+  return s.substr(first, s.find_last_not_of(chars) - first + 1);
+}
+
+void printTable(std::ostream &os, const Params &params, const size_t offset,
+                const size_t size, const size_t perRow) {
+  for (size_t i = 0; i < size; ++i)
+    os << (i % perRow ? " " : "\n      ") << std::setw(4)
+       << std::lround(params[offset + i]) << (i + 1 < size ? "," : "");
+}
+} // anonymous namespace
+
+Params tune::initialParams() {
+  Params params(numParams);
+
+  for (size_t type = 0; type < 5; ++type)
+    params[materialOffset + type] = pieceVal[wP + type];
+
+  for (GamePhase phase : {MG, EG}) {
+    for (size_t type = 0; type < 6; ++type)
+      for (size_t sq = 0; sq < regularNC; ++sq)
+        params[pstIndex(phase, type, sq)] = pstWhite[phase][type][sq];
+
+    params[pawnsOffset + phase]     = search::doubledPawn[phase];
+    params[pawnsOffset + 2 + phase] = search::isolatedPawn[phase];
+    params[pawnsOffset + 4 + phase] = search::backwardPawn[phase];
+
+    for (size_t rank = 0; rank < 8; ++rank)
+      params[passedIndex(phase, rank)] = search::passedPawn[phase][rank];
+  }
+
+  return params;
+}
+
+Usage tune::usage(const size_t param) {
+  if (param < pstOffset)
+    return Usage::BOTH;
+  if (param < pawnsOffset)
+    return (param - pstOffset) / (6 * regularNC) == MG ? Usage::MG : Usage::EG;
+  if (param < passedOffset)
+    return (param - pawnsOffset) % 2 == MG ? Usage::MG : Usage::EG;
+  return (param - passedOffset) / 8 == MG ? Usage::MG : Usage::EG;
+}
+
+Features tune::extract(const board::Board &b) {
+  std::array<int, numParams> dense{};
+
+  for (unsigned char piece = wP; piece <= bK; ++piece) {
+    const bool white = pieceCol[piece] == WHITE;
+    const int sign = white ? 1 : -1;
+    const size_t type = (piece - 1) % 6;
+
+    for (unsigned char i = 0; i < b.getPieceNum(piece); ++i) {
+      const size_t sq64 = convert120To64(b.getPieceListSq(piece, i));
+
+      // Kings are always on the board, their values cancel out
+      if (type < 5)
+        dense[materialOffset + type] += sign;
+
+      // pstWhite is laid out from the 8th rank, as in pieceSquare
+      for (GamePhase phase : {MG, EG})
+        dense[pstIndex(phase, type, white ? sq64 ^ 56 : sq64)] += sign;
+    }
+  }
+
+  const search::PawnTerms terms = search::countPawnTerms(b);
+  for (GamePhase phase : {MG, EG}) {
+    dense[pawnsOffset + phase]     += terms.doubled;
+    dense[pawnsOffset + 2 + phase] += terms.isolated;
+    dense[pawnsOffset + 4 + phase] += terms.backward;
+
+    for (size_t rank = 0; rank < 8; ++rank)
+      dense[passedIndex(phase, rank)] += terms.passed[rank];
+  }
+
+  Features f{b.getPhase(), {}};
+  for (size_t i = 0; i < numParams; ++i)
+    if (dense[i])
+      f.coefs.emplace_back(uint16_t(i), int16_t(dense[i]));
+
+  return f;
+}
+
+double tune::weight(const Usage usage, const int phase) {
+  return usage == Usage::BOTH ? 1.0
+       : usage == Usage::MG   ? double(phase) / maxPhase
+                              : double(maxPhase - phase) / maxPhase;
+}
+
+double tune::evaluate(const Features &f, const Params &params) {
+  std::array<double, 3> sums{};
+
+  for (auto [param, coef] : f.coefs)
+    sums[size_t(usage(param))] += coef * params[param];
+
+  return sums[size_t(Usage::BOTH)] +
+         sums[size_t(Usage::MG)] * weight(Usage::MG, f.phase) +
+         sums[size_t(Usage::EG)] * weight(Usage::EG, f.phase);
+}
+
+bool tune::parseLine(std::string_view line, std::string_view &fen,
+                     double &result) {
+  line = trim(line, " \t\r\n;");
+
+  const size_t split = line.find_last_of(" \t");
+  if (split == std::string_view::npos)
+    return false;
+
+  fen = trim(line.substr(0, split), " \t");
+  const std::string_view token = trim(line.substr(split + 1), "[]()\"'");
+
+  if (token == "1-0")
+    result = 1.0;
+  else if (token == "0-1")
+    result = 0.0;
+  else if (token == "1/2-1/2")
+    result = 0.5;
+  else {
+    const char *last = token.data() + token.size();
+    auto [ptr, ec] = std::from_chars(token.data(), last, result);
+    if (ec != std::errc() || ptr != last || result < 0 || result > 1)
+      return false;
+  }
+
+  return board::validFEN(fen);
+}
+
+void tune::print(std::ostream &os, const Params &params) {
+  static constexpr const char *types[] = {"P", "N", "B", "R", "Q", "K"};
+  static constexpr const char *phases[] = {"MG", "EG"};
+
+  os << "// pieceVal: P, N, B, R, Q";
+  printTable(os, params, materialOffset, 5, 5);
+
+  for (GamePhase phase : {MG, EG})
+    for (size_t type = 0; type < 6; ++type) {
+      os << "\n// pstWhite " << phases[phase] << " " << types[type];
+      printTable(os, params, pstIndex(phase, type, 0), regularNC, 8);
+    }
+
+  os << "\n// doubledPawn, isolatedPawn, backwardPawn: MG, EG";
+  printTable(os, params, pawnsOffset, 6, 2);
+
+  for (GamePhase phase : {MG, EG}) {
+    os << "\n// passedPawn " << phases[phase];
+    printTable(os, params, passedIndex(phase, 0), 8, 8);
+  }
+
+  os << "\n";
+}
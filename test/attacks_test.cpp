@@ -0,0 +1,57 @@
+// Licensed after GNU GPL v3
+
+#include <bit>
+
+#include <gtest/gtest.h>
+
+#include "../include/attacks.hpp"
+
+TEST(attacks_test, knight_attacks) {
+  ASSERT_EQ(std::popcount(knightAttacks[convert120To64(A1)]), 2);
+  ASSERT_EQ(std::popcount(knightAttacks[convert120To64(D4)]), 8);
+  ASSERT_EQ(std::popcount(knightAttacks[convert120To64(H5)]), 4);
+}
+
+TEST(attacks_test, king_attacks) {
+  ASSERT_EQ(std::popcount(kingAttacks[convert120To64(A1)]), 3);
+  ASSERT_EQ(std::popcount(kingAttacks[convert120To64(E4)]), 8);
+}
+
+TEST(attacks_test, pawn_attacks) {
+  size_t expected = setMask[convert120To64(D5)] | setMask[convert120To64(F5)];
+  ASSERT_EQ(pawnAttacks[WHITE][convert120To64(E4)], expected);
+
+  expected = setMask[convert120To64(B6)];
+  ASSERT_EQ(pawnAttacks[BLACK][convert120To64(A7)], expected);
+}
+
+TEST(attacks_test, rook_attacks_empty_board) {
+  ASSERT_EQ(std::popcount(rookAttacks(convert120To64(A1), 0ull)), 14);
+  ASSERT_EQ(std::popcount(rookAttacks(convert120To64(E4), 0ull)), 14);
+}
+
+TEST(attacks_test, bishop_attacks_empty_board) {
+  ASSERT_EQ(std::popcount(bishopAttacks(convert120To64(A1), 0ull)), 7);
+  ASSERT_EQ(std::popcount(bishopAttacks(convert120To64(D4), 0ull)), 13);
+}
+
+TEST(attacks_test, rook_attacks_blocked) {
+  // Blockers on C4 and E6: rook on E4 sees C4, but not B4 and A4,
+  // sees E6, but not E7 and E8
+  size_t occupied = setMask[convert120To64(C4)] | setMask[convert120To64(E6)];
+  size_t attacks = rookAttacks(convert120To64(E4), occupied);
+
+  ASSERT_TRUE(attacks & setMask[convert120To64(C4)]);
+  ASSERT_FALSE(attacks & setMask[convert120To64(B4)]);
+  ASSERT_TRUE(attacks & setMask[convert120To64(E6)]);
+  ASSERT_FALSE(attacks & setMask[convert120To64(E7)]);
+  ASSERT_EQ(std::popcount(attacks), 10);
+}
+
+TEST(attacks_test, queen_attacks) {
+  size_t occupied = setMask[convert120To64(F6)] | setMask[convert120To64(D1)];
+  unsigned char sq64 = convert120To64(D4);
+
+  ASSERT_EQ(queenAttacks(sq64, occupied),
+            bishopAttacks(sq64, occupied) | rookAttacks(sq64, occupied));
+}
@@ -0,0 +1,195 @@
+// Licensed after GNU GPL v3
+
+#include <gtest/gtest.h>
+
+#include "../include/board.hpp"
+
+namespace {
+  class board_test : public ::testing::Test {
+  protected:
+    // Makes the move from `from` to `to` if it's in the move list
+    static bool play(board::Board &b, unsigned char from, unsigned char to) {
+      move::MoveList l;
+      l.generateLegalMoves(b);
+      for (auto m : l)
+        if (m.getFrom() == from && m.getTo() == to)
+          return b.makeLegalMove(m);
+      return false;
+    }
+  };
+} // anonymous namespace
+
+TEST_F(board_test, history_take_back) {
+  board::Board b(startPos);
+  size_t key = b.getPosKey();
+
+  ASSERT_TRUE(b.history_empty());
+  ASSERT_TRUE(play(b, E2, E4));
+  ASSERT_TRUE(play(b, E7, E5));
+  ASSERT_FALSE(b.history_empty());
+
+  b.takeBackMove();
+  b.takeBackMove();
+
+  ASSERT_TRUE(b.history_empty());
+  ASSERT_EQ(b.getPosKey(), key);
+}
+
+TEST_F(board_test, history_full) {
+  board::Board b(startPos);
+
+  for (int i = 0; i < maxGameMoves / 4; ++i) {
+    ASSERT_TRUE(play(b, G1, F3));
+    ASSERT_TRUE(play(b, G8, F6));
+    ASSERT_TRUE(play(b, F3, G1));
+    ASSERT_TRUE(play(b, F6, G8));
+  }
+  ASSERT_TRUE(b.history_full());
+
+  // Moves are refused and the board stays as it was
+  size_t key = b.getPosKey();
+  ASSERT_FALSE(play(b, E2, E4));
+
+  move::MoveList l;
+  l.generateAllMoves(b);
+  for (auto m : l)
+    ASSERT_FALSE(b.makeMove(m));
+  ASSERT_EQ(b.getPosKey(), key);
+
+  b.takeBackMove();
+  ASSERT_FALSE(b.history_full());
+  ASSERT_TRUE(play(b, F6, G8));
+}
+
+TEST_F(board_test, fifty_move_counter) {
+  board::Board b(startPos);
+
+  ASSERT_TRUE(play(b, G1, F3));
+  ASSERT_TRUE(play(b, G8, F6));
+  ASSERT_EQ(b.getFiftyMove(), 2);
+
+  ASSERT_TRUE(play(b, E2, E4));
+  ASSERT_EQ(b.getFiftyMove(), 0);
+
+  b.takeBackMove();
+  ASSERT_EQ(b.getFiftyMove(), 2);
+}
+
+TEST_F(board_test, repetition) {
+  board::Board b(startPos);
+
+  ASSERT_TRUE(play(b, G1, F3));
+  ASSERT_TRUE(play(b, G8, F6));
+  ASSERT_TRUE(play(b, F3, G1));
+  ASSERT_FALSE(b.isRepetition());
+  ASSERT_TRUE(play(b, F6, G8));
+  ASSERT_TRUE(b.isRepetition());
+
+  // Pawn move makes previous positions unreachable
+  ASSERT_TRUE(play(b, E2, E4));
+  ASSERT_TRUE(play(b, E7, E5));
+  ASSERT_FALSE(b.isRepetition());
+}
+
+TEST_F(board_test, zobrist_keys_are_fixed) {
+  static_assert(sideKey != 0ull);
+  static_assert(pieceKeys[wP][E2] != pieceKeys[wP][E4]);
+  static_assert(castleKeys[WKC | WQC | BKC | BQC] != castleKeys[0]);
+
+  board::Board b(startPos);
+  ASSERT_EQ(b.getPosKey(), b.generate());
+  ASSERT_NE(b.getPosKey(), 0ull);
+}
+
+TEST_F(board_test, transposition_key) {
+  board::Board b(startPos);
+
+  ASSERT_TRUE(play(b, G1, F3));
+  ASSERT_TRUE(play(b, B8, C6));
+  ASSERT_TRUE(play(b, B1, C3));
+  ASSERT_TRUE(play(b, G8, F6));
+  size_t key = b.getPosKey();
+
+  b.takeBackMove();
+  b.takeBackMove();
+  b.takeBackMove();
+  b.takeBackMove();
+
+  ASSERT_TRUE(play(b, B1, C3));
+  ASSERT_TRUE(play(b, G8, F6));
+  ASSERT_TRUE(play(b, G1, F3));
+  ASSERT_TRUE(play(b, B8, C6));
+
+  ASSERT_EQ(b.getPosKey(), key);
+  ASSERT_EQ(key, board::Board("r1bqkb1r/pppppppp/2n2n2/8/8/2N2N2/PPPPPPPP/"
+                              "R1BQKB1R w KQkq - 4 3").getPosKey());
+}
+
+TEST_F(board_test, update_rebuilds_lists) {
+  board::Board b(startPos);
+  ASSERT_TRUE(play(b, E2, E4));
+
+  b.update();
+  b.update();
+  b.check();
+
+  ASSERT_EQ(b.getPieceNum(wP), 8);
+  ASSERT_EQ(b.getKing(BLACK), E8);
+  ASSERT_EQ(b.getColorBB(BOTH), b.getColorBB(WHITE) | b.getColorBB(BLACK));
+}
+
+TEST_F(board_test, attackers_to) {
+  board::Board b("4k3/8/8/3pP3/8/2N5/3r4/K2R4 w - d6 0 1");
+  auto bb = [](unsigned char sq) { return setMask[convert120To64(sq)]; };
+
+  // Pieces of both colors, pawns attack forward
+  ASSERT_EQ(b.attackersTo(E4), bb(C3) | bb(D5));
+  ASSERT_EQ(b.attackersTo(D6), bb(E5));
+  ASSERT_EQ(b.attackersTo(E6), 0ull);
+  ASSERT_EQ(b.attackersTo(D3), bb(D2));
+
+  // Rook d1 is seen through rook d2 when d2 is removed
+  size_t occupied = b.getColorBB(BOTH) ^ bb(D2);
+  ASSERT_EQ(b.attackersTo(D3, occupied), bb(D1));
+}
+
+TEST_F(board_test, piece_square_sums) {
+  board::Board b(startPos);
+
+  // Start position is symmetric
+  ASSERT_EQ(b.getPsq(MG), 0);
+  ASSERT_EQ(b.getPsq(EG), 0);
+  ASSERT_EQ(b.getPhase(), maxPhase);
+
+  // Castling, capture and promotion are updated incrementally,
+  // as if the board was scanned from scratch
+  b.parseFEN("r3k2r/pPppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/1PPBBPPP/R3K2R w KQkq - 0 1");
+  for (auto [from, to] : {std::pair{E1, G1}, {E6, D5}, {B7, A8}}) {
+    ASSERT_TRUE(play(b, from, to));
+
+    board::Board scanned = b;
+    scanned.update();
+    ASSERT_EQ(b.getPsq(MG), scanned.getPsq(MG));
+    ASSERT_EQ(b.getPsq(EG), scanned.getPsq(EG));
+  }
+
+  // Extra queens don't raise the phase above the maximum
+  ASSERT_EQ(b.getPhase(), maxPhase);
+
+  b.parseFEN("4k3/8/8/8/8/8/8/RN2K3 w - - 0 1");
+  ASSERT_EQ(b.getPhase(), 3);
+
+  b.parseFEN("4k3/pppppppp/8/8/8/8/PPPPPPPP/4K3 w - - 0 1");
+  ASSERT_EQ(b.getPhase(), 0);
+}
+
+TEST_F(board_test, valid_fen) {
+  ASSERT_TRUE(board::validFEN(startPos));
+  ASSERT_TRUE(board::validFEN("4k3/8/8/3Pp3/8/8/8/4K3 w - e6"));
+
+  ASSERT_FALSE(board::validFEN(""));
+  ASSERT_FALSE(board::validFEN("rnbqkbnr/pppp"));
+  ASSERT_FALSE(board::validFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w"));
+  ASSERT_FALSE(board::validFEN("8/8/4k3/8/8/8/3PP3/4K3 w - e3"));
+  ASSERT_FALSE(board::validFEN("4k3/8/8/8/8/NNN5/NNNNNNNN/4K3 w - -"));
+}
@@ -0,0 +1,206 @@
+// Licensed after GNU GPL v3
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "../include/search.hpp"
+#include "../include/util.hpp"
+
+namespace {
+  const std::string kiwipete =
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+
+  // Network with small random weights, so that sums don't overflow
+  class nnue_test : public ::testing::Test {
+  protected:
+    static inline std::string path;
+
+    static void SetUpTestSuite() {
+      path = (std::filesystem::temp_directory_path() / "nnue_test.nnue").string();
+      std::ofstream file(path, std::ios::binary);
+      util::PRNG rng(2024);
+
+      auto write = [&file, &rng]<typename T>(T, size_t count, int range, int base = 0) {
+        for (size_t i = 0; i < count; ++i) {
+          T value = T(int(rng.rand() % (2 * range + 1)) - range + base);
+          file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+      };
+
+      nnue::Header header;
+      file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      write(int16_t(), nnue::halfDims, 32, 32);
+      write(int16_t(), nnue::inputs * nnue::halfDims, 16);
+      write(int32_t(), nnue::l1, 2000);
+      write(int8_t(), nnue::l1 * 2 * nnue::halfDims, 32);
+      write(int32_t(), nnue::l2, 2000);
+      write(int8_t(), nnue::l2 * nnue::l1, 32);
+      write(int32_t(), 1, 1000);
+      write(int8_t(), nnue::l2, 64);
+    }
+
+    static void TearDownTestSuite() {
+      nnue::unload();
+      std::filesystem::remove(path);
+    }
+
+    void SetUp() override { ASSERT_TRUE(nnue::load(path)); }
+
+    // Evaluation with the accumulator computed from scratch
+    static int fresh(const board::Board &b) {
+      board::Board copy = b;
+      nnue::AccumulatorStack acc;
+      copy.attach(&acc);
+      return nnue::evaluate(copy, acc);
+    }
+  };
+} // anonymous namespace
+
+TEST_F(nnue_test, load) {
+  ASSERT_TRUE(nnue::loaded());
+  ASSERT_EQ(std::filesystem::file_size(path), nnue::fileSize);
+
+  ASSERT_FALSE(nnue::load(path + ".missing"));
+  ASSERT_FALSE(nnue::loaded());
+
+  // Wrong layout
+  std::string truncated = path + ".truncated";
+  std::filesystem::copy_file(path, truncated);
+  std::filesystem::resize_file(truncated, nnue::fileSize - 1);
+  ASSERT_FALSE(nnue::load(truncated));
+  std::filesystem::remove(truncated);
+}
+
+TEST_F(nnue_test, incremental_update) {
+  board::Board b(kiwipete);
+  nnue::AccumulatorStack acc;
+  b.attach(&acc);
+
+  const int root = nnue::evaluate(b, acc);
+  ASSERT_EQ(root, fresh(b));
+
+  // Random game covers castling, captures, en passant and promotions
+  util::PRNG rng(7);
+  int made = 0;
+  for (; made < 100; ++made) {
+    move::MoveList l;
+    l.generateLegalMoves(b);
+    if (l.size() == 0)
+      break;
+
+    b.makeLegalMove(l[rng.rand() % l.size()]);
+    ASSERT_EQ(nnue::evaluate(b, acc), fresh(b));
+  }
+
+  for (; made > 0; --made)
+    b.takeBackMove();
+  ASSERT_EQ(nnue::evaluate(b, acc), root);
+
+  // Accumulators don't follow a new position
+  b.parseFEN(startPos);
+  ASSERT_EQ(b.getAccumulators(), nullptr);
+}
+
+TEST_F(nnue_test, long_game) {
+  // Mostly king moves, far more of them than a search has plies
+  board::Board b("4k3/8/8/3n4/8/8/8/4K1N1 w - - 0 1");
+  nnue::AccumulatorStack acc;
+  b.attach(&acc);
+
+  const int root = nnue::evaluate(b, acc);
+  util::PRNG rng(3);
+  int made = 0;
+  for (; made < 1000; ++made) {
+    move::MoveList l;
+    l.generateLegalMoves(b);
+    if (l.size() == 0)
+      break;
+
+    b.makeLegalMove(l[rng.rand() % l.size()]);
+    if (made % 100 == 0) {
+      ASSERT_EQ(nnue::evaluate(b, acc), fresh(b));
+    }
+  }
+  ASSERT_EQ(nnue::evaluate(b, acc), fresh(b));
+
+  for (; made > 0; --made)
+    b.takeBackMove();
+  ASSERT_EQ(nnue::evaluate(b, acc), root);
+}
+
+TEST_F(nnue_test, symmetry) {
+  // Both perspectives share weights, so the mirrored position
+  // is the same for the side to move
+  board::Board b(kiwipete);
+  board::Board mirrored("r3k2r/pppbbppp/2n2q1P/1P2p3/3pn3/BN2PNP1/P1PPQPB1/R3K2R b KQkq - 0 1");
+  ASSERT_EQ(fresh(b), fresh(mirrored));
+}
+
+TEST_F(nnue_test, saturated) {
+  // Every neuron is at the top of its clipped ReLU, so the output
+  // is beyond mate scores before it's clamped
+  const std::string saturated = path + ".saturated";
+  const int maxScore = search::mate - search::maxPly - 1;
+
+  for (int8_t out : {int8_t(127), int8_t(-128)}) {
+    {
+      std::ofstream file(saturated, std::ios::binary);
+      auto fill = [&file]<typename T>(T value, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+          file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+      };
+
+      nnue::Header header;
+      file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      fill(int16_t(127), nnue::halfDims);
+      fill(int16_t(0), nnue::inputs * nnue::halfDims);
+      fill(int32_t(0), nnue::l1);
+      fill(int8_t(127), nnue::l1 * 2 * nnue::halfDims);
+      fill(int32_t(0), nnue::l2);
+      fill(int8_t(127), nnue::l2 * nnue::l1);
+      fill(int32_t(0), 1);
+      fill(out, nnue::l2);
+    }
+
+    ASSERT_TRUE(nnue::load(saturated));
+    const int score = fresh(board::Board(kiwipete));
+    ASSERT_EQ(score, out > 0 ? maxScore : -maxScore);
+    ASSERT_FALSE(search::isMate(score));
+  }
+
+  std::filesystem::remove(saturated);
+}
+
+TEST_F(nnue_test, search) {
+  board::Board b(kiwipete);
+  size_t key = b.getPosKey();
+
+  auto result = search::search(b, {.depth = 3});
+  ASSERT_EQ(result.depth, 3);
+  ASSERT_FALSE(result.pv.empty());
+  ASSERT_EQ(b.getPosKey(), key);
+  ASSERT_EQ(b.getAccumulators(), nullptr);
+
+  // Accumulators of the caller stay attached and in place
+  nnue::AccumulatorStack acc;
+  b.attach(&acc);
+  const int root = nnue::evaluate(b, acc);
+
+  move::MoveList l;
+  l.generateLegalMoves(b);
+  b.makeLegalMove(l[0]);
+
+  search::search(b, {.depth = 3});
+  ASSERT_EQ(b.getAccumulators(), &acc);
+  ASSERT_EQ(nnue::evaluate(b, acc), fresh(b));
+
+  b.takeBackMove();
+  ASSERT_EQ(nnue::evaluate(b, acc), root);
+
+  search::TranspositionTable tt(1);
+  search::parallelSearch(b, {.depth = 3}, tt, 2);
+  ASSERT_EQ(b.getAccumulators(), &acc);
+  ASSERT_EQ(nnue::evaluate(b, acc), root);
+}
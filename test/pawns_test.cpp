@@ -0,0 +1,77 @@
+// Licensed after GNU GPL v3
+
+#include <bit>
+
+#include <gtest/gtest.h>
+
+#include "../include/pawns.hpp"
+
+namespace {
+  using Score = std::array<int, 2>;
+
+  Score pawnScore(const std::string_view fen) {
+    return search::evaluatePawns(board::Board(fen)).score;
+  }
+} // anonymous namespace
+
+TEST(pawns, masks) {
+  const unsigned char e4 = convert120To64(E4), a2 = convert120To64(A2);
+
+  ASSERT_EQ(std::popcount(search::pawnMask.adjacent[e4]), 16);
+  ASSERT_EQ(std::popcount(search::pawnMask.front[WHITE][e4]), 4);
+  ASSERT_EQ(std::popcount(search::pawnMask.front[BLACK][e4]), 3);
+  ASSERT_EQ(std::popcount(search::pawnMask.passed[WHITE][e4]), 12);
+  ASSERT_EQ(std::popcount(search::pawnMask.support[BLACK][e4]), 10);
+
+  // Edge files have only one neighbour
+  ASSERT_EQ(std::popcount(search::pawnMask.passed[WHITE][a2]), 12);
+  ASSERT_EQ(search::pawnMask.support[WHITE][a2],
+            setMask[convert120To64(B1)] | setMask[convert120To64(B2)]);
+}
+
+TEST(pawns, structure) {
+  // Isolated passed pawns on the second rank
+  ASSERT_EQ(pawnScore("4k3/8/8/8/8/8/P1P5/4K3 w - - 0 1"), Score({-10, -10}));
+
+  // Doubled isolated passed pawns
+  ASSERT_EQ(pawnScore("4k3/8/8/8/8/4P3/4P3/4K3 w - - 0 1"), Score({-15, -20}));
+
+  // White d3 is backward, black e5 is isolated
+  ASSERT_EQ(pawnScore("4k3/8/8/4p3/4P3/3P4/8/4K3 w - - 0 1"), Score({2, 5}));
+
+  // Symmetric structures are equal
+  ASSERT_EQ(pawnScore(startPos), Score({0, 0}));
+  ASSERT_EQ(pawnScore("4k3/pp3p2/2p5/8/8/2P5/PP3P2/4K3 w - - 0 1"), Score({0, 0}));
+}
+
+TEST(pawns, pawn_key) {
+  board::Board b(startPos);
+  const size_t start = b.getPawnKey();
+  ASSERT_NE(start, 0ull);
+
+  // Only pawn moves change the key
+  b.parseFEN("rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R b KQkq - 1 1");
+  ASSERT_EQ(b.getPawnKey(), start);
+
+  b.parseFEN("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1");
+  ASSERT_NE(b.getPawnKey(), start);
+
+  ASSERT_EQ(board::Board("4k3/8/8/8/8/8/8/4K2R w - - 0 1").getPawnKey(), 0ull);
+}
+
+TEST(pawns, table) {
+  search::PawnTable table(1000);
+  board::Board b("4k3/8/8/4p3/4P3/3P4/8/4K3 w - - 0 1");
+
+  ASSERT_EQ(table.probe(b), search::evaluatePawns(b).score);
+  ASSERT_EQ(table.getHits(), 0u);
+
+  ASSERT_EQ(table.probe(b), search::evaluatePawns(b).score);
+  ASSERT_EQ(table.getProbes(), 2u);
+  ASSERT_EQ(table.getHits(), 1u);
+
+  // Pawnless position is found in the empty table
+  board::Board pawnless("4k3/8/8/8/8/8/8/4K2R w - - 0 1");
+  ASSERT_EQ(table.probe(pawnless), Score({0, 0}));
+  ASSERT_EQ(table.getHits(), 2u);
+}
@@ -10,74 +10,76 @@
 #include <boost/preprocessor/repetition/repeat.hpp>
 
 #include "../include/board.hpp"
+#include "../include/movepicker.hpp"
+#include "../include/perft.hpp"
+#include "../include/position.hpp"
 
 
 namespace {
-  size_t leaves;
-
-  void perft(const unsigned char depth, board::Board& b) {
+  // Pseudo-legal generator, makeMove filters moves
+  size_t perftPseudo(const unsigned char depth, board::Board& b) {
     b.check();
 
-    if (depth == 0) {
-      ++leaves;
-      return;
-    }
+    if (depth == 0)
+      return 1;
 
-    move::MoveList l(b);
+    move::MoveList l;
+    l.generateAllMoves(b);
 
-    std::for_each(l.begin(), l.end(), [&depth, &b, &l](auto elt) {
-      if (b.makeMove(elt)) {
-        perft(depth - 1, b);
+    size_t nodes = 0;
+    for (auto m : l)
+      if (b.makeMove(m)) {
+        nodes += perftPseudo(depth - 1, b);
         b.takeBackMove();
       }
-    });
-  }
 
-  size_t perftTest(const unsigned char depth, board::Board& b) {
-    b.check();
+    return nodes;
+  }
 
-    leaves = 0;
+  // Moves come from the staged MovePicker
+  size_t perftPicker(const unsigned char depth, board::Board& b) {
+    if (depth == 0)
+      return 1;
 
-    move::MoveList l(b);
+    move::MovePicker picker(b);
 
-    std::for_each(l.begin(), l.end(), [&depth, &b, &l](auto elt) {
-      if (b.makeMove(elt)) {
-        perft(depth - 1, b);
+    size_t nodes = 0;
+    for (move::Move m; picker.next(m);)
+      if (b.makeMove(m)) {
+        nodes += perftPicker(depth - 1, b);
         b.takeBackMove();
       }
-    });
 
-    return leaves;
+    return nodes;
+  }
+
+  // Copy-make: every child is a copy of its parent, nothing is taken back
+  size_t perftCopy(const unsigned char depth, const board::Position& p) {
+    if (depth == 0)
+      return 1;
+
+    move::MoveList l;
+    l.generateAllMoves(p);
+
+    size_t nodes = 0;
+    board::Position child;
+    for (auto m : l)
+      if (p.makeMove(m, child))
+        nodes += perftCopy(depth - 1, child);
+
+    return nodes;
   }
 
   class perft_test : public ::testing::Test {
   protected:
-    std::vector<std::pair<std::string, std::array<size_t, 6>>> tests;
+    std::vector<perft::TestCase> tests;
     int N;
-    static constexpr unsigned char depthMax = 6;
 
     void SetUp() override {
       std::ifstream file(PERFT_TESTS_PATH);
-
-      for (std::string tmp; std::getline(file, tmp);) {
-        std::string_view res(tmp);
-
-        auto fend = res.find_first_of(";");
-
-        std::string_view fen = res.substr(0, fend - 1);
-
-        std::array<size_t, depthMax> depths;
-
-        for (int i = 0; i < depthMax; ++i) {
-          auto l = fend + 4;
-          auto r = l + res.substr(l).find_first_of(" ");
-          std::string_view depth = res.substr(l, r - l);
-          depths[i] = std::stoull(std::string {depth});
-          fend = r + 1;
-        }
-        tests.push_back({std::string{fen}, depths});
-      }
-      file.close();
+      auto suite = perft::loadSuite(file);
+      ASSERT_TRUE(suite);
+      tests = std::move(*suite);
 
 #if defined(DEBUG_ONLY)
       N = 4;
@@ -90,12 +92,118 @@ namespace {
   };
 } // anonymous namespace
 
-#define TEST_PERF(z, I, unused)              \
-TEST_F(perft_test, board##I) {                 \
-  auto&& [fen, depths] = tests[I];             \
-  board::Board b{std::string_view(fen)};       \
-  for (int i = 0; i < N; ++i)                  \
-    ASSERT_EQ(perftTest(i + 1, b), depths[i]); \
+TEST_F(perft_test, caller_buffer) {
+  std::array<move::Move, maxMoves> buffer;
+
+  for (auto &&[fen, depths] : tests) {
+    board::Board b{std::string_view(fen)};
+    move::MoveList l;
+
+    l.generateAllMoves(b);
+    ASSERT_EQ(move::generateAllMoves(b, buffer), l.size());
+    ASSERT_TRUE(std::equal(l.begin(), l.end(), buffer.begin(),
+                           [](auto lhs, auto rhs) {
+                             return lhs.getInfo() == rhs.getInfo();
+                           }));
+
+    ASSERT_EQ(move::generateLegalMoves(b, buffer), depths[0]);
+  }
+}
+
+TEST_F(perft_test, move_picker) {
+  for (auto &&[fen, depths] : tests) {
+    board::Board b{std::string_view(fen)};
+    for (int i = 0; i < N - 1; ++i)
+      ASSERT_EQ(perftPicker(i + 1, b), depths[i]);
+  }
+}
+
+TEST_F(perft_test, copy_make) {
+  for (auto &&[fen, depths] : tests) {
+    board::Position p{std::string_view(fen)};
+    for (int i = 0; i < N - 1; ++i)
+      ASSERT_EQ(perftCopy(i + 1, p), depths[i]);
+  }
+}
+
+TEST_F(perft_test, count_legal_moves) {
+  for (auto &&[fen, depths] : tests) {
+    board::Board b{std::string_view(fen)};
+    move::MoveList l;
+    l.generateLegalMoves(b);
+
+    ASSERT_EQ(move::countLegalMoves(b), depths[0]);
+
+    // Children have checks, pins and en passant captures
+    for (auto m : l) {
+      b.makeLegalMove(m);
+      move::MoveList children;
+      children.generateLegalMoves(b);
+      ASSERT_EQ(move::countLegalMoves(b), children.size());
+      b.takeBackMove();
+    }
+  }
+}
+
+TEST_F(perft_test, divide) {
+  for (auto &&[fen, depths] : tests) {
+    board::Board b{std::string_view(fen)};
+    auto moves = perft::divide(b, 2);
+
+    ASSERT_EQ(moves.size(), depths[0]);
+    ASSERT_EQ(std::accumulate(moves.begin(), moves.end(), size_t{0},
+                              [](size_t sum, auto &&entry) {
+                                return sum + entry.nodes;
+                              }),
+              depths[1]);
+  }
+}
+
+TEST_F(perft_test, parallel) {
+  for (auto &&[fen, depths] : tests) {
+    board::Board b{std::string_view(fen)};
+
+    ASSERT_EQ(perft::parallelPerft(b, N - 1, 4, 2), depths[N - 2]);
+    // Split deeper than the tree
+    ASSERT_EQ(perft::parallelPerft(b, 2, 3, 5), depths[1]);
+  }
+}
+
+TEST_F(perft_test, hash_table) {
+  // Tiny tables, so entries are replaced all the time
+  perft::PerftTable table(1), verified(1, true);
+
+  for (auto &&[fen, depths] : tests) {
+    board::Board b{std::string_view(fen)};
+    for (int i = 0; i < N - 1; ++i)
+      ASSERT_EQ(perft::hashPerft(b, i + 1, table), depths[i]);
+
+    ASSERT_EQ(perft::hashPerft(b, 3, verified), depths[2]);
+  }
+
+  ASSERT_EQ(verified.getCollisions(), 0);
+}
+
+TEST(perft, parse_test_case) {
+  auto test = perft::parseTestCase("4k3/8/8/8/8/8/8/4K2R w K - 0 1 ;D1 15 ;D2 66 ;D3 1197");
+
+  ASSERT_EQ(test.fen, "4k3/8/8/8/8/8/8/4K2R w K - 0 1");
+  ASSERT_EQ(test.nodes, (std::vector<size_t>{15, 66, 1197}));
+}
+
+#define TEST_PERF(z, I, unused)                     \
+TEST_F(perft_test, board##I) {                        \
+  auto&& [fen, depths] = tests[I];                    \
+  board::Board b{std::string_view(fen)};              \
+  for (int i = 0; i < N; ++i)                         \
+    ASSERT_EQ(perft::perft(b, i + 1), depths[i]);     \
+}                                                     \
+                                                      \
+TEST_F(perft_test, pseudo_legal_board##I) {           \
+  auto&& [fen, depths] = tests[I];                    \
+  board::Board b{std::string_view(fen)};              \
+  for (int i = 0; i < N - 1; ++i)                     \
+    ASSERT_EQ(perftPseudo(i + 1, b), depths[i]);      \
 }
 
 BOOST_PP_REPEAT(PERFT_TESTS_NUM, TEST_PERF, ~)
@@ -0,0 +1,203 @@
+// Licensed after GNU GPL v3
+
+#include <array>
+#include <climits>
+
+#include <gtest/gtest.h>
+
+#include "../include/search.hpp"
+
+namespace {
+  bool isLegal(board::Board &b, const move::Move &m) {
+    move::MoveList l;
+    l.generateLegalMoves(b);
+    for (auto legal : l)
+      if (legal.getInfo() == m.getInfo())
+        return true;
+    return false;
+  }
+} // anonymous namespace
+
+TEST(search, mate_in_one) {
+  board::Board b("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+  auto result = search::search(b, {.depth = 3});
+
+  ASSERT_EQ(result.bestMove.getFrom(), A1);
+  ASSERT_EQ(result.bestMove.getTo(), A8);
+  ASSERT_EQ(result.score, search::mate - 1);
+}
+
+TEST(search, mated) {
+  board::Board b("R5k1/5ppp/8/8/8/8/5PPP/6K1 b - - 0 1");
+  auto result = search::search(b, {.depth = 3});
+
+  ASSERT_EQ(result.score, -search::mate);
+  ASSERT_TRUE(result.pv.empty());
+}
+
+TEST(search, stalemate) {
+  board::Board b("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+  auto result = search::search(b, {.depth = 3});
+
+  ASSERT_EQ(result.score, 0);
+}
+
+TEST(search, wins_material) {
+  board::Board b("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1");
+  auto result = search::search(b, {.depth = 3});
+
+  ASSERT_EQ(result.bestMove.getFrom(), D2);
+  ASSERT_EQ(result.bestMove.getTo(), D5);
+  ASSERT_GT(result.score, 0);
+}
+
+TEST(search, quiescence) {
+  // Pawn e5 is defended, so Qxe5 loses the queen
+  board::Board b("4k3/8/3p4/4p3/8/8/4Q3/4K3 w - - 0 1");
+  auto result = search::search(b, {.depth = 1});
+
+  ASSERT_NE(result.bestMove.getTo(), E5);
+  ASSERT_LT(result.score, pieceVal[wQ] - pieceVal[wP]);
+
+  // Rook is defended by king, queen must escape instead of taking it
+  board::Board hanging("3k4/8/8/4q3/8/8/4R3/4K3 b - - 0 1");
+  result = search::search(hanging, {.depth = 1});
+
+  ASSERT_NE(result.bestMove.getTo(), E2);
+  ASSERT_GE(result.score, pieceVal[wQ] - pieceVal[wR] - 100);
+}
+
+TEST(search, limits) {
+  board::Board b(startPos);
+  size_t key = b.getPosKey();
+
+  auto result = search::search(b, {.depth = 3});
+  ASSERT_EQ(result.depth, 3);
+  ASSERT_EQ(b.getPosKey(), key);
+  ASSERT_EQ(b.getPly(), 0);
+
+  result = search::search(b, {.nodes = 5000});
+  ASSERT_LE(result.nodes, 5000);
+  ASSERT_TRUE(isLegal(b, result.bestMove));
+  ASSERT_EQ(b.getPosKey(), key);
+}
+
+TEST(search, node_limit) {
+  // Search stops right at the limit, even in the middle of an iteration
+  for (auto fen : {std::string_view(startPos),
+                   std::string_view("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1")}) {
+    board::Board b(fen);
+
+    for (size_t limit : {1, 2, 3, 10, 100, 1000, 4321, 20000}) {
+      auto result = search::search(b, {.nodes = limit});
+      ASSERT_LE(result.nodes, limit);
+      ASSERT_TRUE(isLegal(b, result.bestMove));
+    }
+  }
+}
+
+TEST(search, history_full) {
+  // Knights shuffle until no move fits in the history
+  board::Board b(startPos);
+  constexpr std::array<std::pair<unsigned char, unsigned char>, 4> shuffle{
+      {{G1, F3}, {G8, F6}, {F3, G1}, {F6, G8}}};
+
+  for (int i = 0; i < maxGameMoves; ++i) {
+    auto [from, to] = shuffle[i % 4];
+    move::MoveList l;
+    l.generateLegalMoves(b);
+    for (auto m : l)
+      if (m.getFrom() == from && m.getTo() == to) {
+        ASSERT_TRUE(b.makeLegalMove(m));
+      }
+  }
+  ASSERT_TRUE(b.history_full());
+
+  // Search evaluates the position instead of making moves
+  const size_t key = b.getPosKey();
+  search::search(b, {.depth = 3});
+  ASSERT_EQ(b.getPosKey(), key);
+  ASSERT_TRUE(b.history_full());
+}
+
+TEST(search, principal_variation) {
+  board::Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  auto result = search::search(b, {.depth = 3});
+
+  ASSERT_FALSE(result.pv.empty());
+  ASSERT_EQ(result.pv[0].getInfo(), result.bestMove.getInfo());
+
+  for (auto m : result.pv) {
+    ASSERT_TRUE(isLegal(b, m));
+    b.makeLegalMove(m);
+  }
+}
+
+TEST(search, move_ordering) {
+  // Pawn d5 can take queen e6 or knight c6, queen f3 can take knight f6
+  board::Board b("4k3/8/2n1qn2/3P4/8/5Q2/8/4K3 w - - 0 1");
+  move::MoveList l;
+  l.generateAllMoves(b);
+
+  unsigned prev = UINT_MAX;
+  std::vector<move::Move> captures;
+  for (size_t i = 0; i < l.size(); ++i) {
+    move::Move m = l.pickBest(i);
+    ASSERT_LE(m.getScore(), prev);
+    prev = m.getScore();
+
+    ASSERT_EQ(m.isTactical(), m.getCaptured() != EMPTY);
+    if (m.isTactical())
+      captures.push_back(m);
+    else
+      ASSERT_EQ(m.getScore(), 0u);
+  }
+
+  // Most valuable victim first, then least valuable attacker
+  ASSERT_EQ(captures.size(), 3u);
+  ASSERT_EQ(captures[0].getTo(), E6);
+  ASSERT_EQ(captures[1].getFrom(), D5);
+  ASSERT_EQ(captures[1].getTo(), C6);
+  ASSERT_EQ(captures[2].getFrom(), F3);
+}
+
+TEST(search, static_exchange) {
+  // Undefended pawn
+  board::Board b("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1");
+  ASSERT_EQ(search::see(b, move::Move(E1, E5, bP)), pieceVal[bP]);
+
+  // Pawn is defended by a knight and x-rayed by the queen behind
+  // the rook, rook and bishop can't win it back
+  b.parseFEN("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1");
+  ASSERT_EQ(search::see(b, move::Move(D3, E5, bP)), pieceVal[bP] - pieceVal[wN]);
+
+  // En passant opens the file for the rook
+  b.parseFEN("4k3/8/8/3pP3/8/8/3r4/K7 w - d6 0 1");
+  ASSERT_EQ(search::see(b, move::Move(E5, D6, EMPTY, EMPTY, 0x40000)), 0);
+
+  // King can't take back the rook defended by the other rook behind
+  b.parseFEN("4k3/3p4/8/8/8/8/3R4/K2R4 w - - 0 1");
+  ASSERT_EQ(search::see(b, move::Move(D2, D7, bP)), pieceVal[bP]);
+  b.parseFEN("4k3/3p4/8/8/8/8/3R4/K7 w - - 0 1");
+  ASSERT_EQ(search::see(b, move::Move(D2, D7, bP)), pieceVal[bP] - pieceVal[wR]);
+
+  // Quiet move to the square attacked by a pawn
+  b.parseFEN("4k3/8/8/8/8/5p2/8/K1N5 w - - 0 1");
+  ASSERT_EQ(search::see(b, move::Move(C1, E2)), -pieceVal[wN]);
+}
+
+TEST(search, evaluate) {
+  // Mirrored positions have the same score for the side to move
+  board::Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  board::Board mirrored("r3k2r/pppbbppp/2n2q1P/1P2p3/3pn3/BN2PNP1/P1PPQPB1/R3K2R b KQkq - 0 1");
+  ASSERT_EQ(search::evaluate(b), search::evaluate(mirrored));
+
+  // Centralized knight is better in both phases
+  board::Board center("4k3/8/8/8/3N4/8/8/4K3 w - - 0 1");
+  board::Board corner("4k3/8/8/8/8/8/8/N3K3 w - - 0 1");
+  ASSERT_GT(search::evaluate(center), search::evaluate(corner));
+
+  // Kings go to the center in the endgame
+  board::Board active("8/8/8/3k4/8/8/8/4K3 b - - 0 1");
+  ASSERT_GT(search::evaluate(active), 0);
+}
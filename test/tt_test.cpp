@@ -0,0 +1,111 @@
+// Licensed after GNU GPL v3
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../include/search.hpp"
+#include "../include/util.hpp"
+
+TEST(tt, store_probe) {
+  search::TranspositionTable tt(1);
+  search::TTEntry e;
+
+  move::Move m(E2, E4, EMPTY, EMPTY, 0x80000);
+  tt.store(0x1234567ull, m, -250, 7, search::LOWER);
+
+  ASSERT_TRUE(tt.probe(0x1234567ull, e));
+  ASSERT_EQ(e.move.getInfo(), m.getInfo());
+  ASSERT_EQ(e.score, -250);
+  ASSERT_EQ(e.depth, 7);
+  ASSERT_EQ(e.bound, search::LOWER);
+
+  ASSERT_FALSE(tt.probe(0x7654321ull, e));
+
+  // The same position without a move keeps the old one
+  tt.store(0x1234567ull, move::Move(), 30, 9, search::UPPER);
+  ASSERT_TRUE(tt.probe(0x1234567ull, e));
+  ASSERT_EQ(e.move.getInfo(), m.getInfo());
+  ASSERT_EQ(e.score, 30);
+
+  tt.clear();
+  ASSERT_FALSE(tt.probe(0x1234567ull, e));
+
+  // Entry is 16 bytes
+  tt.resize(2);
+  ASSERT_EQ(tt.size() * 16, 2u << 20);
+  ASSERT_FALSE(tt.probe(0x1234567ull, e));
+}
+
+TEST(tt, concurrent_access) {
+  search::TranspositionTable tt(1);
+
+  // Score and depth are derived from the key, so a torn entry
+  // would be seen as the wrong score for its key
+  auto scoreOf = [](size_t key) { return int((key >> 32) % 20000) - 10000; };
+  auto depthOf = [](size_t key) { return (unsigned char)(key >> 33); };
+
+  std::atomic<size_t> mismatches = 0;
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&, t] {
+      util::PRNG rng(t + 1);
+      search::TTEntry e;
+
+      for (int i = 0; i < 200000; ++i) {
+        // All keys go to the same bucket
+        size_t key = (rng.rand() % 1024 + 1) << 32;
+        tt.store(key, move::Move(int(key >> 32)), scoreOf(key), depthOf(key),
+                 search::EXACT);
+        if (tt.probe(key, e) &&
+            (e.score != scoreOf(key) || e.depth != depthOf(key)))
+          ++mismatches;
+      }
+    });
+
+  for (auto &thread : threads)
+    thread.join();
+
+  ASSERT_EQ(mismatches, 0);
+}
+
+TEST(tt, search_with_table) {
+  search::TranspositionTable tt(4);
+  board::Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+  // The root is stored last, with the full depth and the best move
+  auto cold = search::search(b, {.depth = 3}, &tt);
+  search::TTEntry entry;
+  ASSERT_TRUE(tt.probe(b.getPosKey(), entry));
+  ASSERT_EQ(entry.depth, 3);
+  ASSERT_EQ(entry.move.getInfo(), cold.bestMove.getInfo());
+
+  // The same search finds the children of the root in the table
+  auto warm = search::search(b, {.depth = 3}, &tt);
+  ASSERT_EQ(warm.depth, 3);
+  ASSERT_EQ(warm.score, cold.score);
+  ASSERT_LT(warm.nodes, cold.nodes);
+
+  board::Board mate("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+  auto result = search::search(mate, {.depth = 5}, &tt);
+  ASSERT_EQ(result.bestMove.getTo(), A8);
+  ASSERT_EQ(result.score, search::mate - 1);
+}
+
+TEST(tt, parallel_search) {
+  search::TranspositionTable tt(4);
+  board::Board b("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  size_t key = b.getPosKey();
+
+  auto result = search::parallelSearch(b, {.depth = 3}, tt, 4);
+  ASSERT_EQ(result.depth, 3);
+  ASSERT_FALSE(result.pv.empty());
+  ASSERT_EQ(b.getPosKey(), key);
+
+  board::Board mate("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+  result = search::parallelSearch(mate, {.depth = 6}, tt, 3);
+  ASSERT_EQ(result.bestMove.getTo(), A8);
+  ASSERT_EQ(result.score, search::mate - 1);
+}
@@ -0,0 +1,143 @@
+// Licensed after GNU GPL v3
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "../include/search.hpp"
+#include "../include/tune.hpp"
+#include "../include/util.hpp"
+
+TEST(tune, initial_params) {
+  const tune::Params params = tune::initialParams();
+  ASSERT_EQ(params.size(), tune::numParams);
+
+  // Linear model with the engine's parameters is the engine's evaluation,
+  // which only rounds the blend down
+  board::Board b(startPos);
+  util::PRNG rng(11);
+
+  for (int made = 0; made < 200; ++made) {
+    const tune::Features f = tune::extract(b);
+    const double white = tune::evaluate(f, params);
+    const int score = search::evaluate(b);
+
+    ASSERT_LE(std::abs((b.getSide() == WHITE ? score : -score) - white), 1.0);
+    ASSERT_EQ(f.phase, b.getPhase());
+
+    move::MoveList l;
+    l.generateLegalMoves(b);
+    if (l.size() == 0)
+      break;
+    b.makeLegalMove(l[rng.rand() % l.size()]);
+  }
+}
+
+TEST(tune, features) {
+  // Black squares are mirrored, so everything cancels out
+  // in the symmetric position
+  tune::Features f = tune::extract(board::Board(startPos));
+  ASSERT_EQ(f.phase, maxPhase);
+  ASSERT_TRUE(f.coefs.empty());
+
+  f = tune::extract(board::Board("4k3/8/8/8/8/8/P1P5/4K3 w - - 0 1"));
+  ASSERT_EQ(f.phase, 0);
+  ASSERT_NE(std::find(f.coefs.begin(), f.coefs.end(),
+                      std::pair<uint16_t, int16_t>(tune::materialOffset, 2)),
+            f.coefs.end());
+
+  ASSERT_EQ(tune::usage(tune::materialOffset + 4), tune::Usage::BOTH);
+  ASSERT_EQ(tune::usage(tune::pstOffset), tune::Usage::MG);
+  ASSERT_EQ(tune::usage(tune::pawnsOffset - 1), tune::Usage::EG);
+  ASSERT_EQ(tune::usage(tune::passedOffset + 7), tune::Usage::MG);
+  ASSERT_EQ(tune::usage(tune::numParams - 1), tune::Usage::EG);
+}
+
+TEST(tune, parse_line) {
+  std::string_view fen;
+  double result;
+
+  const std::string line = std::string(startPos) + " [0.5]";
+  ASSERT_TRUE(tune::parseLine(line, fen, result));
+  ASSERT_EQ(fen, startPos);
+  ASSERT_EQ(result, 0.5);
+
+  ASSERT_TRUE(tune::parseLine(
+      "8/8/4k3/8/8/4K3/4P3/8 w - - c9 \"1-0\";\r", fen, result));
+  ASSERT_EQ(fen, "8/8/4k3/8/8/4K3/4P3/8 w - - c9");
+  ASSERT_EQ(result, 1.0);
+
+  ASSERT_TRUE(tune::parseLine("8/8/4k3/8/8/4K3/4P3/8 b - - 0 1 0-1", fen, result));
+  ASSERT_EQ(result, 0.0);
+  ASSERT_TRUE(tune::parseLine("8/8/4k3/8/8/4K3/4P3/8 b - - 1/2-1/2", fen, result));
+  ASSERT_EQ(result, 0.5);
+  ASSERT_TRUE(tune::parseLine("8/8/4k3/8/8/4K3/4P3/8 b - - 0.25", fen, result));
+  ASSERT_EQ(result, 0.25);
+
+  ASSERT_FALSE(tune::parseLine("", fen, result));
+  ASSERT_FALSE(tune::parseLine("1-0", fen, result));
+  ASSERT_FALSE(tune::parseLine("8/8/4k3/8/8/4K3/4P3/8 w - - 2-0", fen, result));
+  ASSERT_FALSE(tune::parseLine("8/8/4k3/8/8/4K3/4P3/8 w - - [1.5]", fen, result));
+  ASSERT_FALSE(tune::parseLine("8/8/4k3/8/8/4K3/4P3/8 1-0", fen, result));
+}
+
+TEST(tune, malformed_fen) {
+  std::string_view fen;
+  double result;
+
+  for (auto line : {
+           "8/8/4k3/8/8/4K3/4P3/8 b 1-0",            // no castling field
+           "8/8/4k3/8/8/4K3/4P3/8 w KQkq 1-0",       // no en passant field
+           "8/8/4k3/8/4K3/4P3/8 w - - 1-0",          // 7 ranks
+           "8/8/4k3/8/8/4K3/4P3/8/8 w - - 1-0",      // 9 ranks
+           "8/8/4k3/8/8/4K4/4P3/8 w - - 1-0",        // 9 squares
+           "8/8/4k3/8/8/4K2/4P3/8 w - - 1-0",        // 7 squares
+           "8/8/4k3/8/8/4X3/4P3/8 w - - 1-0",        // unknown piece
+           "8/8/8/8/8/4K3/4P3/8 w - - 1-0",          // no black king
+           "4P3/8/4k3/8/8/4K3/8/8 w - - 1-0",        // pawn on the 8th rank
+           "8/8/4k3/8/8/4K3/4P3/8 x - - 1-0",        // side to move
+           "8/8/4k3/8/8/4K3/4P3/8 w KX - 1-0",       // castling
+           "8/8/4k3/8/8/4K3/4P3/8 w - e4 1-0",       // en passant
+           "8/8/4k3/8/8/4K3/4P3/8 w  - - 1-0",       // double space
+           "\xff\xfe/8/8 w - - 1-0",
+           // en passant square of the side to move
+           "8/8/4k3/8/8/8/3PP3/4K3 w - e3 1-0",
+           // no pawn has passed the en passant square
+           "4k3/8/8/8/8/8/8/4K3 w - e6 1-0",
+           "4k3/4p3/8/4p3/8/8/8/4K3 w - e6 1-0",
+           // more pieces than piece lists hold
+           "4k3/8/8/8/8/PPPPPPPP/PPPPPPPP/4K3 w - - 1-0",
+           "4k3/8/8/8/8/NNN5/NNNNNNNN/4K3 w - - 1-0",
+           "rrrrkrrr/rrrrrrrr/8/8/8/8/8/4K3 b - - 1-0",
+           "4k3/8/8/8/NNNNNNNN/N7/PPPPPPPP/4K3 w - - 1-0",
+       })
+    ASSERT_FALSE(tune::parseLine(line, fen, result)) << line;
+
+  ASSERT_TRUE(tune::parseLine("4k3/8/8/3Pp3/8/8/8/4K3 w - e6 1-0", fen, result));
+  ASSERT_TRUE(tune::parseLine("4k3/8/8/8/3pP3/8/8/4K3 b - e3 1-0", fen, result));
+  ASSERT_TRUE(tune::parseLine("4k3/8/8/8/NNNNNNNN/NN6/8/4K3 w - - 1-0", fen, result));
+}
+
+TEST(tune, print) {
+  std::ostringstream os;
+  tune::print(os, tune::initialParams());
+
+  ASSERT_NE(os.str().find(" 100,  325,  325,  550, 1000"), std::string::npos);
+  ASSERT_NE(os.str().find("// passedPawn EG"), std::string::npos);
+}
+
+TEST(tune, qsearch) {
+  // Quiet position, the static evaluation stands
+  board::Board b(startPos);
+  search::Searcher quiet(b, {});
+  ASSERT_EQ(quiet.qsearch(), search::evaluate(b));
+
+  // Hanging queen is taken
+  b.parseFEN("4k3/8/8/3q4/4P3/8/8/4K3 w - - 0 1");
+  search::Searcher searcher(b, {});
+  const size_t key = b.getPosKey();
+  ASSERT_GT(searcher.qsearch(), search::evaluate(b) + 500);
+  ASSERT_EQ(b.getPosKey(), key);
+}
@@ -0,0 +1,212 @@
+// Licensed after GNU GPL v3
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "perft.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+void usage(const char *name) {
+  std::cerr
+      << "Usage: " << name << " [options]\n"
+      << "  --suite <file>     positions to run on (Perft_tests.txt by default)\n"
+      << "  --time <ms>        minimal time of each benchmark (500 by default)\n"
+      << "  --filter <name>    run only benchmarks containing name\n"
+      << "  --json <file>      also write results as JSON\n";
+}
+
+struct Result {
+  std::string name;
+  size_t ops;
+  double seconds;
+
+  double nsPerOp() const { return seconds * 1e9 / ops; }
+  double opsPerSec() const { return ops / seconds; }
+};
+
+// Keeps results of benchmarked calls alive
+volatile size_t sink;
+
+// `pass` runs the benchmark over every position once and returns number
+// of operations it has made. Passes are repeated for at least `minTime`
+Result measure(const std::string &name, Clock::duration minTime,
+               const std::function<size_t()> &pass) {
+  size_t ops = 0;
+  Clock::duration time{};
+
+  // Warm up
+  pass();
+
+  while (time < minTime) {
+    auto start = Clock::now();
+    ops += pass();
+    time += Clock::now() - start;
+  }
+
+  return {name, ops, std::chrono::duration<double>(time).count()};
+}
+
+void writeJson(std::ostream &os, const std::vector<Result> &results) {
+  os << "{\n  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto &&r = results[i];
+    os << (i ? "," : "") << "\n    {\"name\": \"" << r.name
+       << "\", \"ops\": " << r.ops << std::fixed << std::setprecision(3)
+       << ", \"ns_per_op\": " << r.nsPerOp()
+       << ", \"ops_per_sec\": " << r.opsPerSec() << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  std::string suite, json, filter;
+  int minTimeMs = 500;
+
+#if defined(PERFT_TESTS_PATH)
+  suite = PERFT_TESTS_PATH;
+#endif
+
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+
+    if (arg == "--suite" && i + 1 < argc)
+      suite = argv[++i];
+    else if (arg == "--time" && i + 1 < argc)
+      minTimeMs = std::atoi(argv[++i]);
+    else if (arg == "--filter" && i + 1 < argc)
+      filter = argv[++i];
+    else if (arg == "--json" && i + 1 < argc)
+      json = argv[++i];
+    else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::ifstream file(suite);
+  if (!file) {
+    std::cerr << "Can't open " << suite << "\n";
+    return EXIT_FAILURE;
+  }
+
+  auto tests = perft::loadSuite(file);
+  if (!tests) {
+    std::cerr << "Invalid FEN in " << suite << "\n";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> fens;
+  for (auto &&test : *tests)
+    fens.push_back(test.fen);
+
+  std::vector<board::Board> boards;
+  std::vector<move::MoveList> moves(fens.size());
+  for (size_t i = 0; i < fens.size(); ++i) {
+    boards.emplace_back(std::string_view(fens[i]));
+    moves[i].generateAllMoves(boards[i]);
+  }
+
+  auto minTime = std::chrono::milliseconds(minTimeMs);
+  std::vector<Result> results;
+
+  auto run = [&](const std::string &name, const std::function<size_t()> &pass) {
+    if (name.find(filter) == std::string::npos)
+      return;
+
+    results.push_back(measure(name, minTime, pass));
+
+    auto &&r = results.back();
+    std::cout << std::left << std::setw(24) << r.name << std::right
+              << std::fixed << std::setprecision(2) << std::setw(12)
+              << r.nsPerOp() << " ns/op " << std::setprecision(0)
+              << std::setw(14) << r.opsPerSec() << " ops/sec\n";
+  };
+
+  run("parseFEN", [&] {
+    board::Board b;
+    for (auto &&fen : fens) {
+      b.parseFEN(fen);
+      sink = sink + b.getPosKey();
+    }
+    return fens.size();
+  });
+
+  run("generate", [&] {
+    for (auto &&b : boards)
+      sink = sink + b.generate();
+    return boards.size();
+  });
+
+  run("update", [&] {
+    for (auto &&b : boards) {
+      b.update();
+      sink = sink + b.getKing(WHITE);
+    }
+    return boards.size();
+  });
+
+  run("generateAllMoves", [&] {
+    move::MoveList l;
+    for (auto &&b : boards) {
+      l.generateAllMoves(b);
+      sink = sink + l.size();
+    }
+    return boards.size();
+  });
+
+  run("generateCaptures", [&] {
+    move::MoveList l;
+    for (auto &&b : boards) {
+      l.generateCaptures(b);
+      sink = sink + l.size();
+    }
+    return boards.size();
+  });
+
+  // Illegal moves are taken back by makeMove itself
+  run("makeMove/takeBackMove", [&] {
+    size_t ops = 0;
+    for (size_t i = 0; i < boards.size(); ++i)
+      for (auto m : moves[i]) {
+        if (boards[i].makeMove(m))
+          boards[i].takeBackMove();
+        ++ops;
+      }
+    return ops;
+  });
+
+  run("isAttacked", [&] {
+    size_t attacked = 0;
+    for (auto &&b : boards)
+      for (unsigned char sq64 = 0; sq64 < regularNC; ++sq64)
+        attacked += b.isAttacked(convert64To120(sq64), WHITE) +
+                    b.isAttacked(convert64To120(sq64), BLACK);
+    sink = sink + attacked;
+    return boards.size() * regularNC * 2;
+  });
+
+  run("popBit", [&] {
+    size_t ops = 0, squares = 0;
+    for (auto &&b : boards)
+      for (size_t bb = b.getColorBB(BOTH); bb; ++ops)
+        squares += popBit(bb);
+    sink = sink + squares;
+    return ops;
+  });
+
+  if (!json.empty()) {
+    std::ofstream out(json);
+    writeJson(out, results);
+  }
+
+  return EXIT_SUCCESS;
+}
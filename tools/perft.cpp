@@ -0,0 +1,238 @@
+// Licensed after GNU GPL v3
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "perft.hpp"
+
+namespace {
+constexpr std::string_view startFen =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+using Clock = std::chrono::steady_clock;
+
+struct Settings {
+  // Parallel perft
+  unsigned threads = 1;
+  unsigned char splitDepth = 2;
+
+  // Cached perft, it is used instead of parallel one if set
+  perft::PerftTable *table = nullptr;
+};
+
+std::vector<perft::DivideEntry> countDivide(board::Board &b, int depth,
+                                            const Settings &settings) {
+  if (!settings.table)
+    return perft::parallelDivide(b, depth, settings.threads,
+                                 settings.splitDepth);
+
+  std::vector<perft::DivideEntry> result;
+
+  move::MoveList l;
+  l.generateLegalMoves(b);
+
+  for (auto m : l) {
+    b.makeLegalMove(m);
+    result.push_back({m, perft::hashPerft(b, depth - 1, *settings.table)});
+    b.takeBackMove();
+  }
+
+  return result;
+}
+
+size_t count(board::Board &b, int depth, const Settings &settings) {
+  if (!settings.table)
+    return perft::parallelPerft(b, depth, settings.threads,
+                                settings.splitDepth);
+
+  return perft::hashPerft(b, depth, *settings.table);
+}
+
+void usage(const char *name) {
+  std::cerr
+      << "Usage: " << name << " [options]\n"
+      << "  --fen <FEN>        position to count (start position by default)\n"
+      << "  --depth <N>        count depth N\n"
+      << "  --depth <A-B>      count every depth from A to B\n"
+      << "  --divide           print perft of every root move\n"
+      << "  --threads <N>      count on N threads (1 by default, 0 - all)\n"
+      << "  --split <N>        split the tree into tasks N plies below the root\n"
+      << "                     (2 by default, 3 at most)\n"
+      << "  --hash <MB>        cache subtree counts (single threaded)\n"
+      << "  --verify           cross-check every cache hit with uncached count\n"
+      << "  --suite [file]     run every line of the perft suite,\n"
+      << "                     --depth limits the deepest depth of each line\n";
+}
+
+double seconds(Clock::duration d) {
+  return std::chrono::duration<double>(d).count();
+}
+
+void report(std::ostream &os, size_t nodes, Clock::duration time) {
+  double s = seconds(time);
+  os << std::setw(14) << nodes << " nodes " << std::fixed
+     << std::setprecision(3) << std::setw(10) << s * 1000 << " ms "
+     << std::setw(12) << std::setprecision(0) << (s > 0 ? nodes / s : 0.0)
+     << " nps\n";
+}
+
+// Counts depths [minDepth, maxDepth] of one position
+void runPosition(const std::string_view &fen, int minDepth, int maxDepth,
+                 bool divide, const Settings &settings) {
+  board::Board b(fen);
+
+  for (int depth = minDepth; depth <= maxDepth; ++depth) {
+    auto start = Clock::now();
+    size_t nodes = 0;
+
+    if (divide) {
+      std::cout << "Depth " << depth << ":\n";
+      for (auto &&[m, n] : countDivide(b, depth, settings)) {
+        std::cout << "  " << m.getDumpMove() << ": " << n << "\n";
+        nodes += n;
+      }
+    } else
+      nodes = count(b, depth, settings);
+
+    std::cout << "perft " << std::setw(2) << depth << ": ";
+    report(std::cout, nodes, Clock::now() - start);
+  }
+}
+
+// Runs every line of the suite, returns false if any count is wrong
+bool runSuite(const std::string &path, int maxDepth,
+              const Settings &settings) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "Can't open " << path << "\n";
+    return false;
+  }
+
+  auto tests = perft::loadSuite(file);
+  if (!tests) {
+    std::cerr << "Invalid FEN in " << path << "\n";
+    return false;
+  }
+
+  auto &suite = *tests;
+
+  size_t total = 0;
+  int failed = 0;
+  Clock::duration time{};
+
+  for (size_t i = 0; i < suite.size(); ++i) {
+    auto &&[fen, nodes] = suite[i];
+    board::Board b{std::string_view(fen)};
+
+    int depth = std::min<int>(maxDepth, nodes.size());
+    if (depth == 0)
+      continue;
+
+    auto start = Clock::now();
+    size_t result = count(b, depth, settings);
+    auto elapsed = Clock::now() - start;
+
+    time += elapsed;
+    total += result;
+
+    bool ok = result == nodes[depth - 1];
+    failed += !ok;
+
+    std::cout << std::setw(3) << i + 1 << (ok ? " OK   " : " FAIL ") << "D"
+              << depth;
+    report(std::cout, result, elapsed);
+    if (!ok)
+      std::cout << "    " << fen << ": expected " << nodes[depth - 1] << "\n";
+  }
+
+  std::cout << "Total: " << suite.size() - failed << "/" << suite.size()
+            << " passed\n      ";
+  report(std::cout, total, time);
+
+  return failed == 0;
+}
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  std::string fen{startFen};
+  std::string suite;
+  int minDepth = 1, maxDepth = 5;
+  bool depthSet = false, divide = false, runSuiteMode = false;
+  Settings settings;
+  size_t hashMb = 0;
+  bool verify = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+
+    if (arg == "--fen" && i + 1 < argc)
+      fen = argv[++i];
+    else if (arg == "--depth" && i + 1 < argc) {
+      std::string depth = argv[++i];
+      auto dash = depth.find('-');
+
+      minDepth = std::atoi(depth.c_str());
+      maxDepth = dash == std::string::npos ? minDepth
+                                           : std::atoi(depth.c_str() + dash + 1);
+      depthSet = true;
+    }
+    else if (arg == "--divide")
+      divide = true;
+    else if (arg == "--threads" && i + 1 < argc)
+      settings.threads = std::atoi(argv[++i]);
+    else if (arg == "--split" && i + 1 < argc)
+      settings.splitDepth = std::atoi(argv[++i]);
+    else if (arg == "--hash" && i + 1 < argc)
+      hashMb = std::atoi(argv[++i]);
+    else if (arg == "--verify")
+      verify = true;
+    else if (arg == "--suite") {
+      runSuiteMode = true;
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+        suite = argv[++i];
+    }
+    else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (minDepth < 1 || maxDepth < minDepth || !board::validFEN(fen)) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::optional<perft::PerftTable> table;
+  if (hashMb != 0) {
+    table.emplace(hashMb, verify);
+    settings.table = &*table;
+  }
+
+  bool ok = true;
+
+  if (runSuiteMode) {
+#if defined(PERFT_TESTS_PATH)
+    if (suite.empty())
+      suite = PERFT_TESTS_PATH;
+#endif
+    if (suite.empty()) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    ok = runSuite(suite, depthSet ? maxDepth : 6, settings);
+  } else
+    runPosition(fen, depthSet ? minDepth : 1, maxDepth, divide, settings);
+
+  if (table && verify) {
+    std::cout << "Hash collisions: " << table->getCollisions() << "\n";
+    ok = ok && table->getCollisions() == 0;
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
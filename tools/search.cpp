@@ -0,0 +1,167 @@
+// Licensed after GNU GPL v3
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "perft.hpp"
+#include "search.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+void usage(const char *name) {
+  std::cerr
+      << "Usage: " << name << " [options]\n"
+      << "  --fen <FEN>        position to search (start position by default)\n"
+      << "  --depth <N>        depth limit (8 by default)\n"
+      << "  --nodes <N>        nodes limit of the main thread\n"
+      << "  --threads <N>      search threads (1 by default, 0 - all)\n"
+      << "  --hash <MB>        transposition table size (16 by default)\n"
+      << "  --nnue <file>      evaluate with the network from the file\n"
+      << "  --scaling <N>      time to depth for 1, 2, 4, ... N threads\n"
+      << "                     on the positions of the perft suite\n"
+      << "  --suite <file>     positions for --scaling\n"
+      << "  --positions <N>    use only the first N positions (8 by default)\n";
+}
+
+double seconds(Clock::duration d) {
+  return std::chrono::duration<double>(d).count();
+}
+
+void runSearch(const std::string &fen, const search::Limits &limits,
+               search::TranspositionTable &tt, unsigned threads) {
+  board::Board b{std::string_view(fen)};
+
+  auto start = Clock::now();
+  auto result = search::parallelSearch(b, limits, tt, threads);
+  double s = seconds(Clock::now() - start);
+
+  std::cout << "depth " << int(result.depth) << " score " << result.score
+            << " nodes " << result.nodes << " time " << std::fixed
+            << std::setprecision(3) << s << " s nps " << std::setprecision(0)
+            << (s > 0 ? result.nodes / s : 0.0) << "\npv";
+  for (auto m : result.pv)
+    std::cout << " " << m.getDumpMove();
+  std::cout << "\nbestmove " << result.bestMove.getDumpMove() << "\n";
+}
+
+// Time to reach the depth on every position with 1, 2, 4, ... threads,
+// the table is cleared before each search
+bool runScaling(const std::string &suite, size_t positions,
+                const search::Limits &limits, search::TranspositionTable &tt,
+                unsigned maxThreads) {
+  std::ifstream file(suite);
+  if (!file) {
+    std::cerr << "Can't open " << suite << "\n";
+    return false;
+  }
+
+  auto suiteTests = perft::loadSuite(file);
+  if (!suiteTests) {
+    std::cerr << "Invalid FEN in " << suite << "\n";
+    return false;
+  }
+
+  auto &tests = *suiteTests;
+  tests.resize(std::min(tests.size(), positions));
+
+  std::cout << "Time to depth " << int(limits.depth) << " on " << tests.size()
+            << " positions\n"
+            << std::setw(8) << "threads" << std::setw(12) << "time, s"
+            << std::setw(10) << "speedup" << std::setw(14) << "nodes"
+            << std::setw(14) << "nps" << "\n";
+
+  double base = 0;
+
+  for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+    Clock::duration time{};
+    size_t nodes = 0;
+
+    for (auto &&test : tests) {
+      board::Board b{std::string_view(test.fen)};
+      tt.clear();
+
+      auto start = Clock::now();
+      nodes += search::parallelSearch(b, limits, tt, threads).nodes;
+      time += Clock::now() - start;
+    }
+
+    double s = seconds(time);
+    if (threads == 1)
+      base = s;
+
+    std::cout << std::setw(8) << threads << std::fixed << std::setprecision(3)
+              << std::setw(12) << s << std::setprecision(2) << std::setw(10)
+              << (s > 0 ? base / s : 0.0) << std::setw(14) << nodes
+              << std::setprecision(0) << std::setw(14)
+              << (s > 0 ? nodes / s : 0.0) << "\n";
+  }
+
+  return true;
+}
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  std::string fen{startPos};
+  std::string suite, network;
+  search::Limits limits;
+  limits.depth = 8;
+  unsigned threads = 1, scaling = 0;
+  size_t hashMb = 16, positions = 8;
+
+#if defined(PERFT_TESTS_PATH)
+  suite = PERFT_TESTS_PATH;
+#endif
+
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+
+    if (arg == "--fen" && i + 1 < argc)
+      fen = argv[++i];
+    else if (arg == "--depth" && i + 1 < argc)
+      limits.depth = std::atoi(argv[++i]);
+    else if (arg == "--nodes" && i + 1 < argc)
+      limits.nodes = std::atoll(argv[++i]);
+    else if (arg == "--threads" && i + 1 < argc)
+      threads = std::atoi(argv[++i]);
+    else if (arg == "--hash" && i + 1 < argc)
+      hashMb = std::atoi(argv[++i]);
+    else if (arg == "--nnue" && i + 1 < argc)
+      network = argv[++i];
+    else if (arg == "--scaling" && i + 1 < argc)
+      scaling = std::atoi(argv[++i]);
+    else if (arg == "--suite" && i + 1 < argc)
+      suite = argv[++i];
+    else if (arg == "--positions" && i + 1 < argc)
+      positions = std::atoi(argv[++i]);
+    else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (limits.depth < 1 || hashMb == 0 || !board::validFEN(fen)) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (!network.empty() && !nnue::load(network)) {
+    std::cerr << "Can't load the network from " << network << "\n";
+    return EXIT_FAILURE;
+  }
+
+  search::TranspositionTable tt(hashMb);
+
+  if (scaling != 0)
+    return runScaling(suite, positions, limits, tt, scaling) ? EXIT_SUCCESS
+                                                             : EXIT_FAILURE;
+
+  runSearch(fen, limits, tt, threads);
+
+  return EXIT_SUCCESS;
+}
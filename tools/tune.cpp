@@ -0,0 +1,317 @@
+// Licensed after GNU GPL v3
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "search.hpp"
+#include "tune.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::string data, out;
+  size_t chunk = 1 << 20, batch = 1 << 14;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  unsigned epochs = 10;
+  double k = 0, rate = 1;
+  bool filter = true;
+};
+
+struct Sample {
+  tune::Features features;
+  double result;
+};
+
+void usage(const char *name) {
+  std::cerr
+      << "Usage: " << name << " --data <file> [options]\n"
+      << "  --data <file>      lines of FEN and the result of the game for\n"
+      << "                     white: 1-0, 0-1, 1/2-1/2 or [1.0], [0.5], ...\n"
+      << "  --chunk <N>        positions read into memory at once (1048576)\n"
+      << "  --batch <N>        positions per gradient step (16384)\n"
+      << "  --threads <N>      threads computing gradients (all by default)\n"
+      << "  --epochs <N>       passes over the data (10 by default)\n"
+      << "  --k <K>            scaling of the sigmoid, fitted to the first\n"
+      << "                     chunk with the current parameters by default\n"
+      << "  --rate <R>         learning rate of Adam, centipawns (1 by default)\n"
+      << "  --no-filter        keep positions which aren't quiet\n"
+      << "  --out <file>       tuned tables, written after every epoch\n"
+      << "                     (printed at the end by default)\n";
+}
+
+double seconds(Clock::duration d) {
+  return std::chrono::duration<double>(d).count();
+}
+
+// Calls f(begin, end, thread) on `threads` parts of [0, n) in parallel
+template <typename F> void parallelFor(size_t n, unsigned threads, F &&f) {
+  std::vector<std::thread> workers;
+  const size_t part = (n + threads - 1) / threads;
+
+  for (unsigned t = 0; t < threads && t * part < n; ++t)
+    workers.emplace_back(f, t * part, std::min(n, (t + 1) * part), t);
+
+  for (auto &&worker : workers)
+    worker.join();
+}
+
+// Expected result for white by the score from the view of white
+double sigmoid(const double score, const double k) {
+  return 1 / (1 + std::pow(10.0, -k * score / 400));
+}
+
+double logLoss(const double expected, const double result) {
+  const double p = std::clamp(expected, 1e-12, 1 - 1e-12);
+  return -(result * std::log(p) + (1 - result) * std::log(1 - p));
+}
+
+// Reads up to opts.chunk lines and turns them into samples in parallel.
+// Positions which aren't quiet are skipped if filtering is on: their
+// static evaluation differs from the quiescence search, so the
+// evaluation is tuned on scores it really returns in the search
+bool readChunk(std::istream &in, const Options &opts,
+               std::vector<Sample> &samples, size_t &skipped) {
+  std::vector<std::string> lines;
+  for (std::string line; lines.size() < opts.chunk && std::getline(in, line);)
+    lines.push_back(std::move(line));
+
+  samples.clear();
+  if (lines.empty())
+    return false;
+
+  std::vector<std::vector<Sample>> parts(opts.threads);
+  std::vector<size_t> rejected(opts.threads);
+
+  parallelFor(lines.size(), opts.threads,
+              [&](size_t begin, size_t end, unsigned t) {
+    board::Board b;
+    search::Searcher searcher(b, {});
+
+    for (size_t i = begin; i < end; ++i) {
+      std::string_view fen;
+      double result;
+
+      if (!tune::parseLine(lines[i], fen, result)) {
+        ++rejected[t];
+        continue;
+      }
+
+      b.parseFEN(fen);
+      if (opts.filter && searcher.qsearch() != search::evaluate(b)) {
+        ++rejected[t];
+        continue;
+      }
+
+      parts[t].push_back({tune::extract(b), result});
+    }
+  });
+
+  for (unsigned t = 0; t < opts.threads; ++t) {
+    std::move(parts[t].begin(), parts[t].end(), std::back_inserter(samples));
+    skipped += rejected[t];
+  }
+
+  return true;
+}
+
+// Sum of losses over [begin, end), the gradient of the sum is added
+// to `gradient` if it isn't null
+double batchLoss(const std::vector<Sample> &samples, size_t begin, size_t end,
+                 const tune::Params &params, const double k, unsigned threads,
+                 tune::Params *gradient) {
+  std::vector<double> losses(threads);
+  std::vector<tune::Params> gradients(
+      gradient ? threads : 0, tune::Params(tune::numParams));
+
+  // d(loss) / d(score) = (sigmoid - result) * k * ln(10) / 400
+  const double scale = k * std::log(10.0) / 400;
+
+  parallelFor(end - begin, threads, [&](size_t from, size_t to, unsigned t) {
+    for (size_t i = begin + from; i < begin + to; ++i) {
+      const Sample &s = samples[i];
+      const double expected = sigmoid(tune::evaluate(s.features, params), k);
+      losses[t] += logLoss(expected, s.result);
+
+      if (!gradient)
+        continue;
+
+      const double d = (expected - s.result) * scale;
+      for (auto [param, coef] : s.features.coefs)
+        gradients[t][param] +=
+            d * coef * tune::weight(tune::usage(param), s.features.phase);
+    }
+  });
+
+  double loss = 0;
+  for (unsigned t = 0; t < threads; ++t) {
+    loss += losses[t];
+    if (gradient)
+      for (size_t p = 0; p < tune::numParams; ++p)
+        (*gradient)[p] += gradients[t][p];
+  }
+
+  return loss;
+}
+
+// Golden section search of K with the least loss of the parameters
+double fitK(const std::vector<Sample> &samples, const tune::Params &params,
+            unsigned threads) {
+  auto loss = [&](double k) {
+    return batchLoss(samples, 0, samples.size(), params, k, threads, nullptr);
+  };
+
+  const double ratio = (std::sqrt(5.0) - 1) / 2;
+  double lo = 0.05, hi = 5;
+  double x1 = hi - ratio * (hi - lo), x2 = lo + ratio * (hi - lo);
+  double f1 = loss(x1), f2 = loss(x2);
+
+  while (hi - lo > 1e-3) {
+    if (f1 < f2) {
+      hi = x2, x2 = x1, f2 = f1;
+      x1 = hi - ratio * (hi - lo), f1 = loss(x1);
+    } else {
+      lo = x1, x1 = x2, f1 = f2;
+      x2 = lo + ratio * (hi - lo), f2 = loss(x2);
+    }
+  }
+
+  return (lo + hi) / 2;
+}
+
+class Adam {
+  static constexpr double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+
+  tune::Params m, v;
+  size_t steps = 0;
+
+public:
+  Adam() : m(tune::numParams), v(tune::numParams) {}
+
+  void step(tune::Params &params, const tune::Params &gradient, double rate) {
+    ++steps;
+    const double c1 = 1 - std::pow(beta1, steps),
+                 c2 = 1 - std::pow(beta2, steps);
+
+    for (size_t p = 0; p < tune::numParams; ++p) {
+      m[p] = beta1 * m[p] + (1 - beta1) * gradient[p];
+      v[p] = beta2 * v[p] + (1 - beta2) * gradient[p] * gradient[p];
+      params[p] -= rate * (m[p] / c1) / (std::sqrt(v[p] / c2) + epsilon);
+    }
+  }
+};
+
+bool write(const std::string &path, const tune::Params &params) {
+  std::ofstream file(path);
+  tune::print(file, params);
+  return bool(file);
+}
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  Options opts;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+
+    if (arg == "--data" && i + 1 < argc)
+      opts.data = argv[++i];
+    else if (arg == "--chunk" && i + 1 < argc)
+      opts.chunk = std::atoll(argv[++i]);
+    else if (arg == "--batch" && i + 1 < argc)
+      opts.batch = std::atoll(argv[++i]);
+    else if (arg == "--threads" && i + 1 < argc)
+      opts.threads = std::atoi(argv[++i]);
+    else if (arg == "--epochs" && i + 1 < argc)
+      opts.epochs = std::atoi(argv[++i]);
+    else if (arg == "--k" && i + 1 < argc)
+      opts.k = std::atof(argv[++i]);
+    else if (arg == "--rate" && i + 1 < argc)
+      opts.rate = std::atof(argv[++i]);
+    else if (arg == "--no-filter")
+      opts.filter = false;
+    else if (arg == "--out" && i + 1 < argc)
+      opts.out = argv[++i];
+    else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (opts.data.empty() || opts.chunk == 0 || opts.batch == 0 ||
+      opts.threads == 0 || opts.k < 0 || opts.rate <= 0) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream in(opts.data);
+  if (!in) {
+    std::cerr << "Can't open " << opts.data << "\n";
+    return EXIT_FAILURE;
+  }
+
+  tune::Params params = tune::initialParams();
+  Adam adam;
+  std::vector<Sample> samples;
+
+  for (unsigned epoch = 1; epoch <= opts.epochs; ++epoch) {
+    auto start = Clock::now();
+    size_t positions = 0, skipped = 0;
+    double loss = 0;
+
+    // The file is streamed again on every epoch, only a chunk
+    // of it is in memory at once
+    in.clear();
+    in.seekg(0);
+
+    while (readChunk(in, opts, samples, skipped)) {
+      if (opts.k == 0 && !samples.empty()) {
+        opts.k = fitK(samples, params, opts.threads);
+        std::cout << "k " << std::setprecision(4) << opts.k << std::endl;
+      }
+
+      for (size_t begin = 0; begin < samples.size(); begin += opts.batch) {
+        const size_t end = std::min(samples.size(), begin + opts.batch);
+        tune::Params gradient(tune::numParams);
+
+        loss += batchLoss(samples, begin, end, params, opts.k, opts.threads,
+                          &gradient);
+        for (auto &&g : gradient)
+          g /= double(end - begin);
+
+        adam.step(params, gradient, opts.rate);
+      }
+
+      positions += samples.size();
+    }
+
+    if (positions == 0) {
+      std::cerr << "No positions in " << opts.data << "\n";
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "epoch " << epoch << " loss " << std::fixed
+              << std::setprecision(6) << loss / double(positions)
+              << " positions " << positions << " skipped " << skipped
+              << " time " << std::setprecision(1)
+              << seconds(Clock::now() - start) << " s" << std::endl;
+
+    if (!opts.out.empty() && !write(opts.out, params)) {
+      std::cerr << "Can't write " << opts.out << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (opts.out.empty())
+    tune::print(std::cout, params);
+
+  return EXIT_SUCCESS;
+}